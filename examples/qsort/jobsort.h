@@ -4,14 +4,16 @@
 #include <QDebug>
 
 #include "abstractjob.h"
+#include "jobpool.h"
 
 #define QS_LIMIT        150
 
 /**
  * @class JobSort. This class is used to sort items. Item class should have operators = and
- * < defined
+ * < defined. Since the jobs are spawned recursively, their memory is recycled through
+ * the JobPool.
  */
-class JobSort : public thr::AbstractJob
+class JobSort : public thr::AbstractJob, public thr::PooledJob<JobSort>
 {
     Q_OBJECT
 
@@ -28,7 +28,13 @@ SOURCES += \
     jobmanager.cpp \
     jobqueue.cpp \
     thread.cpp \
-    abstractsessionmanager.cpp
+    abstractsessionmanager.cpp \
+    cancellationtoken.cpp \
+    timerwheel.cpp \
+    abstractschedulingpolicy.cpp \
+    schedulingpolicies.cpp \
+    pausegate.cpp \
+    resultcache.cpp
 
 HEADERS += \
         threadinglib.h \
@@ -37,7 +43,18 @@ HEADERS += \
     jobmanager.h \
     jobqueue.h \
     thread.h \
-    abstractsessionmanager.h
+    abstractsessionmanager.h \
+    submissionqueue.h \
+    jobpool.h \
+    cancellationtoken.h \
+    retrypolicy.h \
+    timerwheel.h \
+    abstractschedulingpolicy.h \
+    schedulingpolicies.h \
+    pausegate.h \
+    resultcache.h \
+    dataport.h \
+    taskgraph.h
 
 unix {
     target.path = /usr/lib
@@ -1,6 +1,9 @@
+#include <typeinfo>
+
 #include <QDebug>
 
 #include "abstractjob.h"
+#include "dataport.h"
 
 namespace thr {
 
@@ -9,11 +12,23 @@ namespace thr {
 AbstractJob::AbstractJob(QString qsName) : QObject()
 {
     setName(qsName);
-    m_iError = 0;
-    m_bStop = false;
+    m_iError.storeRelease(0);
+    m_iTimeout = 0;
+    m_iAttempts = 0;
+    m_iRunTime = -1;
+    m_dCost = 0.0;
+    m_iPriority = 0;
+    m_iWorker = -1;
+    m_iAffinityKey = -1;
+    m_iFirstUnfinished = 0;
+    m_bIdempotent = false;
     m_bFinished = false;
     m_bSpawned = false;
+    m_bSkipped = false;
     m_pThread = thread();
+    m_pGate = nullptr;
+    m_pCache = nullptr;
+    m_bCached = false;
 }
 
 //-----------------------------------------------------------------------------
@@ -33,18 +48,22 @@ QString AbstractJob::errorText(int iErr) const
 
 bool AbstractJob::canStart() const
 {
-    while ((m_vspDependency.count() > 0) && (m_vspDependency.first()->isFinished() == true)) {
-        m_vspDependency.removeFirst();
+    // the processed dependencies are kept, so the scheduling policy can still see them
+    while (
+           (m_iFirstUnfinished < m_vspDependency.count()) &&
+           (m_vspDependency[m_iFirstUnfinished]->isFinished() == true)
+           ) {
+        ++m_iFirstUnfinished;
     }
-    return (m_vspDependency.count() == 0);
+    return (m_iFirstUnfinished == m_vspDependency.count());
 }
 
 //-----------------------------------------------------------------------------
 
-void AbstractJob::addDependency(QSharedPointer<AbstractJob> spJob)
+void AbstractJob::addDependency(JobPointer spJob)
 {
-    if (spJob.data() != 0) {
-        m_vspDependency.append(spJob);
+    if (spJob.isNull() == false) {
+        m_vspDependency.append(std::move(spJob));
     }
 }
 
@@ -52,8 +71,12 @@ void AbstractJob::addDependency(QSharedPointer<AbstractJob> spJob)
 
 void AbstractJob::cleanup()
 {
-    if ((m_iError == 0) && (m_bStop == false)) {
+    if ((m_iError.loadAcquire() == 0) && (isStopped() == false)) {
         m_bFinished = true;
+        // the consumers, which are done, free the values nobody needs anymore
+        for (int i = 0; i < m_vpInputPorts.count(); ++i) {
+            m_vpInputPorts[i]->release();
+        }
     }
 }
 
@@ -61,13 +84,14 @@ void AbstractJob::cleanup()
 
 void AbstractJob::exec()
 {
-    m_bStop = false;
-    m_iError = 0;
-    process();
+    m_token.reset();
+    m_iError.storeRelease(0);
+    m_bSkipped = false;
+    processCached();
     release();
-    if (m_iError != 0) {
+    if (isError() == true) {
         emit signalError();
-    }   else if (m_bStop == true) {
+    }   else if (isStopped() == true) {
         emit signalStopped();
     }   else {
         emit signalFinished();
@@ -76,9 +100,83 @@ void AbstractJob::exec()
 
 //-----------------------------------------------------------------------------
 
+void AbstractJob::processCached()
+{
+    m_bCached = false;
+    QByteArray baKey;
+    if (m_pCache != nullptr) {
+        baKey = cacheKey();
+    }
+    if (baKey.isEmpty() == false) {
+        // jobs of different classes may use equal keys
+        baKey = QByteArray(typeid(*this).name()) + '\0' + baKey;
+    }
+    if (baKey.isEmpty() == true) {
+        processGuarded();
+    }   else if (loadCached(baKey) == true) {
+        m_bCached = true;
+    }   else {
+        processGuarded();
+        if ((isError() == false) && (isStopped() == false)) {
+            storeCached(baKey);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void AbstractJob::processGuarded()
+{
+    m_exception = nullptr;
+    try {
+        process();
+    }   catch (...) {
+        // an exception must not escape into the thread, it is rethrown by the caller
+        m_exception = std::current_exception();
+        m_iError.storeRelease(jeException);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+bool AbstractJob::loadCached(const QByteArray& baKey)
+{
+    QByteArray baResult;
+    if (m_pCache->find(baKey, baResult) == false) {
+        return false;
+    }
+    QDataStream ds(baResult);
+    // the results may be kept on disk by another version of Qt
+    ds.setVersion(QDataStream::Qt_5_0);
+    return (loadResult(ds) == true) && (ds.status() == QDataStream::Ok);
+}
+
+//-----------------------------------------------------------------------------
+
+void AbstractJob::storeCached(const QByteArray& baKey)
+{
+    QByteArray baResult;
+    QDataStream ds(&baResult, QIODevice::WriteOnly);
+    ds.setVersion(QDataStream::Qt_5_0);
+    saveResult(ds);
+    m_pCache->insert(baKey, baResult);
+}
+
+//-----------------------------------------------------------------------------
+
 void AbstractJob::stop()
 {
-    m_bStop = true;
+    m_token.cancel();
+}
+
+//-----------------------------------------------------------------------------
+
+bool AbstractJob::waitIfPaused()
+{
+    if (m_pGate == nullptr) {
+        return isStopped() == false;
+    }
+    return m_pGate->pass(m_token);
 }
 
 //-----------------------------------------------------------------------------
@@ -92,7 +190,7 @@ void AbstractJob::release()
 
 void AbstractJob::reportError(int iErr)
 {
-    m_iError = iErr;
+    m_iError.storeRelease(iErr);
 }
 
 //-----------------------------------------------------------------------------
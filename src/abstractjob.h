@@ -11,17 +11,199 @@
  *                                                                                  *
  ************************************************************************************/
 
+#include <cstddef>
+#include <utility>
+#include <exception>
+
 #include <QObject>
 #include <QThread>
 #include <QVector>
+#include <QAtomicInt>
+#include <QMetaType>
+#include <QByteArray>
+#include <QDataStream>
+
+#include "cancellationtoken.h"
+#include "pausegate.h"
+#include "retrypolicy.h"
+#include "resultcache.h"
 
 #define CHECK_JOB_STOP() \
-    if (m_bStop == true) {\
+    if (isStopped() == true) {\
+        return;\
+    }
+
+#define CHECK_JOB_PAUSE() \
+    if (waitIfPaused() == false) {\
         return;\
     }
 
 namespace thr {
 
+/**
+ * @brief The JobError enum. Error codes reported by the library itself. Negative
+ * error codes are reserved for the library, jobs should report errors with codes
+ * greater than zero
+ */
+enum JobError {
+    jeNoError = 0,                  //!< no error
+    jeException = -1,               //!< process() method threw an exception, see AbstractJob::exception()
+    jeTimeout = -2,                 //!< processing exceeded the job deadline, see AbstractJob::setTimeout()
+};
+
+class AbstractJob;
+class AbstractInputPort;
+
+/**
+ * @brief The JobPointer class. This is a smart pointer, which holds a reference
+ * to a job object.
+ *
+ * @details The reference count is stored in the job object itself, so unlike
+ * QSharedPointer, JobPointer needs no separately allocated control block and copying
+ * it costs a single atomic increment on the job object. When the last JobPointer
+ * referencing a job is destroyed, the job is deleted. Moving a JobPointer does not
+ * touch the reference count at all, so the ownership should be passed on by moving
+ * whenever the source pointer is not needed anymore. <br/><br/>
+ * A job object should be referenced by JobPointer objects only. Wrapping the same job
+ * into a QSharedPointer or deleting it directly, while it is referenced by a
+ * JobPointer, will result in the job being deleted twice.
+ */
+class JobPointer
+{
+public:
+    /**
+     * @brief JobPointer. Constructs a null pointer
+     */
+    JobPointer() : m_pJob(nullptr)
+    {   }
+    /**
+     * @brief JobPointer. Constructs a null pointer
+     */
+    JobPointer(std::nullptr_t) : m_pJob(nullptr)
+    {   }
+    /**
+     * @brief JobPointer. Constructs a pointer, which references the given job
+     * @param pJob. Pointer to the job object created on the heap
+     */
+    explicit JobPointer(AbstractJob* pJob);
+    /**
+     * @brief JobPointer. Copy constructor
+     * @param sp. Pointer to copy
+     */
+    JobPointer(const JobPointer& sp);
+    /**
+     * @brief JobPointer. Move constructor. Reference count is not changed.
+     * @param sp. Pointer to move from. It becomes a null pointer.
+     */
+    JobPointer(JobPointer&& sp) : m_pJob(sp.m_pJob)
+    {   sp.m_pJob = nullptr; }
+    /**
+     * @brief ~JobPointer. Destructor. Deletes the job, if this was its last reference
+     */
+    ~JobPointer();
+
+    /**
+     * @brief operator =. Assignment operator
+     * @param sp. Pointer to copy
+     * @return reference to this pointer
+     */
+    JobPointer& operator=(const JobPointer& sp)
+    {
+        JobPointer spCopy(sp);
+        swap(spCopy);
+        return *this;
+    }
+    /**
+     * @brief operator =. Move assignment operator. Reference count of the moved
+     * job is not changed.
+     * @param sp. Pointer to move from. It becomes a null pointer.
+     * @return reference to this pointer
+     */
+    JobPointer& operator=(JobPointer&& sp)
+    {
+        JobPointer spMoved(std::move(sp));
+        swap(spMoved);
+        return *this;
+    }
+
+    /**
+     * @brief data. Returns the raw pointer to the job
+     * @return raw pointer to the job
+     */
+    AbstractJob* data() const
+    {   return m_pJob; }
+    /**
+     * @brief operator ->. Returns the raw pointer to the job
+     * @return raw pointer to the job
+     */
+    AbstractJob* operator->() const
+    {   return m_pJob; }
+    /**
+     * @brief operator *. Returns the reference to the job
+     * @return reference to the job
+     */
+    AbstractJob& operator*() const
+    {   return *m_pJob; }
+    /**
+     * @brief isNull. Returns true, if this is a null pointer
+     * @return true, if this is a null pointer and false otherwise
+     */
+    bool isNull() const
+    {   return m_pJob == nullptr; }
+    /**
+     * @brief operator bool. Returns true, if this is not a null pointer
+     */
+    explicit operator bool() const
+    {   return m_pJob != nullptr; }
+    /**
+     * @brief operator !. Returns true, if this is a null pointer
+     */
+    bool operator!() const
+    {   return m_pJob == nullptr; }
+
+    /**
+     * @brief clear. Releases the reference and makes this a null pointer
+     */
+    void clear()
+    {
+        JobPointer spNull;
+        swap(spNull);
+    }
+    /**
+     * @brief swap. Swaps the references of this and the given pointer
+     * @param sp. Pointer to swap the references with
+     */
+    void swap(JobPointer& sp)
+    {   std::swap(m_pJob, sp.m_pJob); }
+
+    /**
+     * @brief operator ==. Compares the referenced jobs
+     */
+    bool operator==(const JobPointer& sp) const
+    {   return m_pJob == sp.m_pJob; }
+    /**
+     * @brief operator !=. Compares the referenced jobs
+     */
+    bool operator!=(const JobPointer& sp) const
+    {   return m_pJob != sp.m_pJob; }
+    /**
+     * @brief operator ==. Compares the referenced job with the given one
+     */
+    bool operator==(const AbstractJob* pJob) const
+    {   return m_pJob == pJob; }
+    /**
+     * @brief operator !=. Compares the referenced job with the given one
+     */
+    bool operator!=(const AbstractJob* pJob) const
+    {   return m_pJob != pJob; }
+
+private:
+    /**
+     * @brief m_pJob. Pointer to the referenced job
+     */
+    AbstractJob* m_pJob;
+};
+
 /**
  * @brief The AbstractJob class. This is base class for all jobs, which are
  * supposed to be executed in by a JobManager in a separate thread.
@@ -38,13 +220,22 @@ namespace thr {
  * the m_iError to a value greater than zero, indicating the type of the error and
  * exit. There is no need for the derived class to emit the signal signalError(),
  * because AbstractJob::exec() method will do that, if m_iError is greater than
- * zero. <br/><br/>
+ * zero. The process() method can throw an exception as well. AbstractJob::exec()
+ * catches it, stores it (see exception()) and sets the error code to jeException,
+ * so the job is treated as any other failed job. <br/><br/>
  * If the derived class processing should be interruptable, the process() method
  * of the derived class should check the stop flag using CHECK_JOB_STOP() macro as
  * often as feasible. This macro will exit
  * the method if stop flag is set to true. If processing was stopped by setting
  * the stop flag, AbstractJob::exec() method will emit signal
- * signalStopped(). <br/><br/>
+ * signalStopped(). If the processing should be pausable as well, the process()
+ * method should use CHECK_JOB_PAUSE() macro instead, which also waits there while
+ * the JobManager is paused (see JobManager::pause()). The stop flag is held by the
+ * job's cancellation token, which
+ * is a child of the JobManager's token while the job is processed, so stopping the
+ * JobManager reaches the job immediately. If the process() method has to block or
+ * wait, it should wait on the cancellationToken() or register a callback with it,
+ * so it can be woken up when the job is stopped. <br/><br/>
  * After AbstractJob::exec() method regains control after the process() method exit,
  * it checks the value of m_iError and stop flag. If m_iError is greater than zero,
  * signal signalError() will be emitted. If stop flag is set to true, signal
@@ -103,6 +294,8 @@ class AbstractJob : public QObject
 
     friend class JobQueue;
     friend class JobManager;
+    friend class JobPointer;
+    friend class AbstractInputPort;
 
 public:
     /**
@@ -148,13 +341,155 @@ public:
      * @return error text for given error code
      */
     virtual QString errorText(int iErr) const;
+    /**
+     * @brief retryPolicy. Reimplement this method to let the JobManager retry the
+     * processing of this job, if it fails. The default policy does not retry.
+     * @return retry policy for this job
+     */
+    virtual RetryPolicy retryPolicy() const
+    {   return RetryPolicy(); }
+    /**
+     * @brief attempts. Returns the number of times the JobManager started
+     * processing this job
+     * @return number of processing attempts
+     */
+    int attempts() const
+    {   return m_iAttempts; }
+    /**
+     * @brief runTime. Returns the time the last processing of this job took, as
+     * measured by the JobManager
+     * @return processing time in [ms] or -1, if the job was not processed yet
+     */
+    qint64 runTime() const
+    {   return m_iRunTime; }
+
+    /**
+     * @brief setCost. Sets the estimated processing time of this job. The JobManager
+     * uses it to find the critical path through the dependency graph (see
+     * JobManager::setCriticalPathScheduling()).
+     * @param dCost. Estimated processing time in [ms]. If it is 0 or negative, the
+     * median processing time of the finished jobs of the same class is used instead
+     */
+    void setCost(double dCost)
+    {   m_dCost = dCost; }
+    /**
+     * @brief cost. Returns the estimated processing time of this job
+     * @return estimated processing time in [ms] or 0, if it was not set
+     */
+    double cost() const
+    {   return m_dCost; }
+
+    /**
+     * @brief setPriority. Sets the priority of this job. It is used by the
+     * PriorityPolicy scheduling policy (see JobManager::setSchedulingPolicy()) to start
+     * the jobs with higher priority first.
+     * @param iPriority. Priority of the job. The default priority is 0
+     */
+    void setPriority(int iPriority)
+    {   m_iPriority = iPriority; }
+    /**
+     * @brief priority. Returns the priority of this job
+     * @return priority of the job
+     */
+    int priority() const
+    {   return m_iPriority; }
+    /**
+     * @brief worker. Returns the slot index of the JobManager thread, which processed
+     * this job the last time
+     * @return slot index of the thread or -1, if the job was not processed yet
+     */
+    int worker() const
+    {   return m_iWorker; }
+    /**
+     * @brief setAffinityKey. Sets the affinity key of this job. The LocalityPolicy
+     * scheduling policy prefers to process the jobs with the same key in the same
+     * thread, e.g. the jobs processing adjacent tiles of an image (see LocalityPolicy).
+     * @param iKey. Affinity key. If it is negative, the job has no affinity key
+     */
+    void setAffinityKey(int iKey)
+    {   m_iAffinityKey = iKey; }
+    /**
+     * @brief affinityKey. Returns the affinity key of this job
+     * @return affinity key or -1, if the job has no affinity key
+     */
+    int affinityKey() const
+    {   return m_iAffinityKey; }
+    /**
+     * @brief setAffinityJob. Sets the job, whose thread this job prefers to be
+     * processed in. This is usually the dependency, which produces the data this job
+     * consumes. It takes precedence over the affinity key.
+     * @param spJob. Pointer to the job or null pointer to remove the preference
+     */
+    void setAffinityJob(thr::JobPointer spJob)
+    {   m_spAffinity = std::move(spJob); }
+    /**
+     * @brief affinityJob. Returns the job, whose thread this job prefers to be
+     * processed in
+     * @return pointer to the job or null pointer, if there is no such job
+     */
+    const JobPointer& affinityJob() const
+    {   return m_spAffinity; }
+
+    /**
+     * @brief setIdempotent. Marks the job as idempotent, which means that processing
+     * a copy of the job created by clone() gives the same result as processing the job
+     * itself. If speculation is turned on in the JobManager (see
+     * JobManager::setSpeculation()), a duplicate of an idempotent job, which runs much
+     * longer than other jobs of the same class, can be processed in an idle thread.
+     * The job should check the stop flag regularly, since the slower of both copies
+     * is stopped.
+     * @param bIdempotent. True to mark the job as idempotent and false otherwise
+     */
+    void setIdempotent(bool bIdempotent)
+    {   m_bIdempotent = bIdempotent; }
+    /**
+     * @brief isIdempotent. Returns the value of the idempotent flag
+     * @return true, if the job is idempotent and false otherwise
+     */
+    bool isIdempotent() const
+    {   return m_bIdempotent; }
+    /**
+     * @brief clone. Reimplement this method in idempotent jobs to create a copy of
+     * the job, which can be processed instead of this job. The copy should hold its
+     * own result, so both copies can be processed at the same time.
+     * @return pointer to the new copy or null pointer, if the job cannot be copied
+     */
+    virtual AbstractJob* clone() const
+    {   return nullptr; }
+    /**
+     * @brief adoptResult. Reimplement this method in idempotent jobs to take over the
+     * result of the copy created by clone(). It is called from the JobManager's thread,
+     * after the copy finished first and this job was stopped.
+     * @param pDuplicate. Pointer to the copy, which finished first
+     */
+    virtual void adoptResult(AbstractJob* pDuplicate)
+    {   Q_UNUSED(pDuplicate); }
+    /**
+     * @brief cacheKey. Reimplement this method in deterministic jobs to return a key,
+     * which describes all the inputs of the job. Jobs of the same class with equal
+     * keys must give equal results. If the JobManager has a result cache (see
+     * JobManager::setResultCache()), the result is taken from the cache instead of
+     * processing the job, whenever it is there. saveResult() and loadResult() have to
+     * be reimplemented as well.
+     * @return key of the job inputs or an empty array, if the job should not be cached
+     */
+    virtual QByteArray cacheKey() const
+    {   return QByteArray(); }
 
     /**
      * @brief isStopped. Returns true, if the job was stopped and false otherwise
      * @return true, if the job was stopped and false otherwise
      */
     bool isStopped() const
-    {   return m_bStop; }
+    {   return m_token.isCancelled(); }
+
+    /**
+     * @brief cancellationToken. Returns the cancellation token of this job, which
+     * holds the stop flag
+     * @return reference to the cancellation token
+     */
+    CancellationToken& cancellationToken()
+    {   return m_token; }
 
     /**
      * @brief isError. Returns true, if the job was stopped because of an internal
@@ -163,13 +498,53 @@ public:
      * otherwise
      */
     bool isError() const
-    {   return m_iError != 0; }
+    {   return m_iError.loadAcquire() != 0; }
     /**
      * @brief errorCode. Returns the error code
      * @return error code. If the job finished successfully, it will return 0
      */
     int errorCode() const
-    {   return m_iError; }
+    {   return m_iError.loadAcquire(); }
+    /**
+     * @brief exception. Returns the exception thrown from the process() method
+     * @return exception thrown from the process() method or null pointer, if no
+     * exception was thrown
+     */
+    std::exception_ptr exception() const
+    {   return m_exception; }
+
+    /**
+     * @brief setTimeout. Sets the deadline for processing this job. If the job is
+     * processed by the JobManager and its processing takes longer than this, the
+     * JobManager's watchdog will stop the job, count it as failed with the error code
+     * jeTimeout and continue processing the other jobs with a new thread.
+     * @param iMS. Deadline in [ms]. If it is 0 or negative, the JobManager's job
+     * timeout is used (see JobManager::setJobTimeout())
+     */
+    void setTimeout(int iMS)
+    {   m_iTimeout = iMS; }
+    /**
+     * @brief timeout. Returns the deadline for processing this job
+     * @return deadline in [ms] or 0, if the job has no deadline of its own
+     */
+    int timeout() const
+    {   return m_iTimeout; }
+
+    /**
+     * @brief isSkipped. Returns true, if the job was not processed, because one of
+     * the jobs it depends on finished with an error and JobManager error policy
+     * is set to jepSkipDependents
+     * @return true, if the job was skipped and false otherwise
+     */
+    bool isSkipped() const
+    {   return m_bSkipped; }
+    /**
+     * @brief isCached. Returns true, if the result was taken from the result cache
+     * and the job was not processed
+     * @return true, if the result came from the cache and false otherwise
+     */
+    bool isCached() const
+    {   return m_bCached; }
 
     /**
      * @brief isSpawned. Returns the value of the spawned flag
@@ -187,9 +562,9 @@ public:
     {   return m_pThread; }
 
     /**
-     * @brief canStart. This method first deletes all the dependencies, which
-     * have already been processed, from the list of dependencies. If the list
-     * of dependencies is empty, it will return true, otherwise it will return
+     * @brief canStart. This method first skips all the dependencies, which
+     * have already been processed, in the list of dependencies. If all the
+     * dependencies are processed, it will return true, otherwise it will return
      * false. The derived class can reimplement this method to check additional
      * conditions, but it should always first call AbstractJob::canStart() in
      * order to preserve the dependencies checking; if AbstractJob::canStart()
@@ -211,21 +586,29 @@ public:
 
     /**
      * @brief addDependency. Adds new dependency to the vector of dependencies.
-     * @param spJob. Shared pointer to the job, that has to be finished
+     * @param spJob. Pointer to the job, that has to be finished
      * before this job is started.
      */
-    void addDependency(QSharedPointer<thr::AbstractJob> spJob);
+    void addDependency(thr::JobPointer spJob);
     /**
      * @brief dependencyCount. Returns the number of dependencies
      * @return number of dependencies left to finish
      */
     int dependencyCount() const
-    {   return m_vspDependency.count(); }
+    {   return m_vspDependency.count() - m_iFirstUnfinished; }
+    /**
+     * @brief dependencies. Returns all the dependencies of this job, including the
+     * ones, which have already been processed
+     * @return vector of pointers to the jobs this job depends on
+     */
+    const QVector<JobPointer>& dependencies() const
+    {   return m_vspDependency; }
 
     /**
      * @brief cleanup. This method will be called when the job is finished. It can
      * be used to release some resources, which are not needed anymore after the
-     * job is processed. If you reimplement this method in the derived class,
+     * job is processed. The values of the input ports (see InputPort) are released
+     * here, if the job finished successfully. If you reimplement this method in the derived class,
      * make sure you call AbstractJob::cleanup in the beginning of the
      * reimplemented method.
      */
@@ -241,7 +624,8 @@ public slots:
      */
     virtual void exec();
     /**
-     * @brief stop. Sets the stop flag. In order to stop the execution as soon
+     * @brief stop. Sets the stop flag by cancelling the job's cancellation token.
+     * In order to stop the execution as soon
      * as possible after the stop() method has been called, use the CHECK_JOB_STOP
      * macro in process() method as often as feasible.
      */
@@ -278,7 +662,10 @@ protected:
      * Calling this method should create the next job that
      * is spawned when this job is finished (if necessary) and return a pointer to it.
      * This method will be called by the JobManager's handleJobFinished method repeatedly
-     * until it returns 0. It will be called before this job's cleanup method is called.
+     * until it returns 0. The first call may be made from the thread, which processed
+     * this job (see JobManager::setContinuationDepth()), so the spawned job must not
+     * depend on the thread it is created in. It will be called before this job's
+     * cleanup method is called.
      * To see the example how to use this method properly, navigate to examples/qsort.
      * @return next job that is spawned when this job is finished. If no more jobs are
      * spawned, it should return 0.
@@ -286,6 +673,32 @@ protected:
     virtual AbstractJob* nextSpawnedJob()
     {   return 0; }
 
+    /**
+     * @brief waitIfPaused. Waits while the JobManager processing this job is paused.
+     * Use it through CHECK_JOB_PAUSE() macro at the points, where the processing can
+     * be held without losing its progress
+     * @return true, if the processing should continue and false, if the job was
+     * stopped
+     */
+    bool waitIfPaused();
+
+    /**
+     * @brief saveResult. Reimplement this method in cached jobs to write the result
+     * into the stream (see cacheKey())
+     * @param ds. Stream for the result
+     */
+    virtual void saveResult(QDataStream& ds) const
+    {   Q_UNUSED(ds); }
+    /**
+     * @brief loadResult. Reimplement this method in cached jobs to read the result
+     * written by saveResult() from the stream. It has to set the output ports of
+     * the job (see OutputPort) as well, since process() is not called
+     * @param ds. Stream with the result
+     * @return true, if the result was read and false, if the job should be processed
+     */
+    virtual bool loadResult(QDataStream& ds)
+    {   Q_UNUSED(ds); return false; }
+
 protected slots:
     /**
      * @brief release. Releases the object from the current thread
@@ -298,6 +711,28 @@ protected slots:
     virtual void reportError(int iErr);
 
 private:
+    /**
+     * @brief processCached. Loads the result from the result cache, if it is there,
+     * and calls processGuarded() and stores the result otherwise
+     */
+    void processCached();
+    /**
+     * @brief processGuarded. Calls the process() method and catches any exception
+     * thrown from it
+     */
+    void processGuarded();
+    /**
+     * @brief loadCached. Looks up the result in the result cache and loads it
+     * @param baKey. Cache key of this job
+     * @return true, if the result was loaded from the cache and false otherwise
+     */
+    bool loadCached(const QByteArray& baKey);
+    /**
+     * @brief storeCached. Stores the result into the result cache
+     * @param baKey. Cache key of this job
+     */
+    void storeCached(const QByteArray& baKey);
+
     /**
      * @brief setSpawned. Sets the spawned flag to true
      */
@@ -311,28 +746,75 @@ protected:
     QString m_qsName;
 
     /**
-     * @brief m_bStop. Stop flag
+     * @brief m_token. Cancellation token, which holds the stop flag
      */
-    bool m_bStop;
+    CancellationToken m_token;
     /**
      * @brief m_bFinished. This flag will be set to true, when job is finished
      * successfully.
      */
     bool m_bFinished;
     /**
-     * @brief m_vspDependency. This vector contains shared pointers to jobs, that
+     * @brief m_vspDependency. This vector contains pointers to jobs, that
      * this job is dependent on. This job cannot be started until all the jobs from
      * this vector are finished successfully.
      */
-    mutable QVector<QSharedPointer<AbstractJob> > m_vspDependency;
+    QVector<JobPointer> m_vspDependency;
 
 private:
+    /**
+     * @brief m_iFirstUnfinished. Index of the first dependency, which was not
+     * processed yet when canStart() was called the last time
+     */
+    mutable int m_iFirstUnfinished;
     /**
      * @brief m_iError. Error code. If an error occurs, set this variable to
      * a value greater than zero using the reportError() method. Default
-     * value is 0, which means no error.
+     * value is 0, which means no error. It is atomic, since the JobManager's
+     * watchdog can set it while the job is still processing.
+     */
+    QAtomicInt m_iError;
+    /**
+     * @brief m_iTimeout. Deadline for processing of this job in [ms]
+     */
+    int m_iTimeout;
+    /**
+     * @brief m_iAttempts. Number of processing attempts made by the JobManager
+     */
+    int m_iAttempts;
+    /**
+     * @brief m_iRunTime. Duration of the last processing in [ms]
+     */
+    qint64 m_iRunTime;
+    /**
+     * @brief m_dCost. Estimated processing time in [ms]
+     */
+    double m_dCost;
+    /**
+     * @brief m_iPriority. Priority of the job
+     */
+    int m_iPriority;
+    /**
+     * @brief m_iWorker. Slot index of the thread, which processed the job the last time
+     */
+    int m_iWorker;
+    /**
+     * @brief m_iAffinityKey. Affinity key of the job
+     */
+    int m_iAffinityKey;
+    /**
+     * @brief m_spAffinity. Job, whose thread this job prefers to be processed in
+     */
+    JobPointer m_spAffinity;
+    /**
+     * @brief m_bIdempotent. Idempotent flag, which is set to true, if the job can
+     * be duplicated with clone()
+     */
+    bool m_bIdempotent;
+    /**
+     * @brief m_exception. Exception thrown from the process() method
      */
-    int m_iError;
+    std::exception_ptr m_exception;
 
     /**
      * @brief m_pThread. Pointer to the thread, where the object was created
@@ -343,8 +825,64 @@ private:
      * was spawned from another job
      */
     bool m_bSpawned;
+    /**
+     * @brief m_bSkipped. Skipped flag, which is set to true, if the job was not
+     * processed because one of its dependencies failed
+     */
+    bool m_bSkipped;
+    /**
+     * @brief m_pGate. Pointer to the pause gate of the JobManager processing this job
+     */
+    PauseGate* m_pGate;
+    /**
+     * @brief m_pCache. Pointer to the result cache of the JobManager processing this job
+     */
+    ResultCache* m_pCache;
+    /**
+     * @brief m_bCached. Set to true, if the result was taken from the result cache
+     */
+    bool m_bCached;
+    /**
+     * @brief m_vpInputPorts. Input ports of this job, registered by their constructors
+     */
+    QVector<AbstractInputPort*> m_vpInputPorts;
+    /**
+     * @brief m_iRefCount. Number of JobPointer objects referencing this job
+     */
+    mutable QAtomicInt m_iRefCount;
 };
 
+//-----------------------------------------------------------------------------
+
+inline JobPointer::JobPointer(AbstractJob* pJob) : m_pJob(pJob)
+{
+    if (m_pJob != nullptr) {
+        m_pJob->m_iRefCount.ref();
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+inline JobPointer::JobPointer(const JobPointer& sp) : m_pJob(sp.m_pJob)
+{
+    if (m_pJob != nullptr) {
+        m_pJob->m_iRefCount.ref();
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+inline JobPointer::~JobPointer()
+{
+    if ((m_pJob != nullptr) && (m_pJob->m_iRefCount.deref() == false)) {
+        delete m_pJob;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
 }   // namespace
 
+Q_DECLARE_METATYPE(thr::JobPointer)
+
 #endif // ABSTRACTJOB_H
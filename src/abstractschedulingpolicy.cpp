@@ -0,0 +1,107 @@
+#include <QDebug>
+
+#include "abstractschedulingpolicy.h"
+#include "jobmanager.h"
+
+namespace thr {
+
+//-----------------------------------------------------------------------------
+
+SchedulingQueue::SchedulingQueue(JobManager* pJM)
+{
+    m_pJM = pJM;
+}
+
+//-----------------------------------------------------------------------------
+
+int SchedulingQueue::count() const
+{
+    return m_pJM->m_quWaiting.count();
+}
+
+//-----------------------------------------------------------------------------
+
+int SchedulingQueue::jobIndex(int iPos) const
+{
+    return m_pJM->m_quWaiting[iPos];
+}
+
+//-----------------------------------------------------------------------------
+
+AbstractJob* SchedulingQueue::job(int iPos) const
+{
+    return m_pJM->m_vspJobs[m_pJM->m_quWaiting[iPos]].data();
+}
+
+//-----------------------------------------------------------------------------
+
+bool SchedulingQueue::isReady(int iPos) const
+{
+    int iInd = m_pJM->m_quWaiting[iPos];
+    return (m_pJM->isInReleaseWindow(iInd) == true) && (m_pJM->m_vspJobs[iInd]->canStart() == true);
+}
+
+//-----------------------------------------------------------------------------
+
+double SchedulingQueue::cost(int iPos) const
+{
+    int iInd = m_pJM->m_quWaiting[iPos];
+    return (iInd < m_pJM->m_vCost.count())? m_pJM->m_vCost[iInd] : 0.0;
+}
+
+//-----------------------------------------------------------------------------
+
+double SchedulingQueue::rank(int iPos) const
+{
+    int iInd = m_pJM->m_quWaiting[iPos];
+    return (iInd < m_pJM->m_vRank.count())? m_pJM->m_vRank[iInd] : 0.0;
+}
+
+//-----------------------------------------------------------------------------
+
+QVector<int> SchedulingQueue::idleThreads() const
+{
+    QVector<int> vIdle;
+    vIdle.reserve(m_pJM->m_quIdle.count());
+    for (int i = 0; i < m_pJM->m_quIdle.count(); ++i) {
+        vIdle.append(m_pJM->m_quIdle[i]->index());
+    }
+    return vIdle;
+}
+
+//-----------------------------------------------------------------------------
+
+AbstractSchedulingPolicy::~AbstractSchedulingPolicy()
+{   }
+
+//-----------------------------------------------------------------------------
+
+int AbstractSchedulingPolicy::selectThread(const AbstractJob* pJob, const QVector<int>& vIdle)
+{
+    Q_UNUSED(pJob);
+    Q_UNUSED(vIdle);
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+
+void AbstractSchedulingPolicy::reset()
+{   }
+
+//-----------------------------------------------------------------------------
+
+bool AbstractSchedulingPolicy::needsCosts() const
+{
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+
+bool AbstractSchedulingPolicy::needsRanks() const
+{
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+
+}   // namespace
@@ -0,0 +1,158 @@
+#ifndef ABSTRACTSCHEDULINGPOLICY_H
+#define ABSTRACTSCHEDULINGPOLICY_H
+
+/************************************************************************************
+ *                                                                                  *
+ *  Project:     ThreadingLib                                                       *
+ *  File:        abstractschedulingpolicy.h                                         *
+ *  Class:       SchedulingQueue, AbstractSchedulingPolicy                          *
+ *  Author:      Bojan Kverh                                                        *
+ *  License:     LGPL                                                               *
+ *                                                                                  *
+ ************************************************************************************/
+
+#include <QVector>
+
+namespace thr {
+
+class AbstractJob;
+class JobManager;
+
+/**
+ * @brief The SchedulingQueue class. This class gives the scheduling policy read access
+ * to the queue of the jobs waiting to be started.
+ *
+ * @details The jobs are listed in the order they were queued. The position of a job
+ * in the queue is not its index in the JobManager; use jobIndex() to get the latter.
+ * Only the jobs, for which isReady() returns true, can be selected. The estimated
+ * costs and the upward ranks are computed the first time they are needed.
+ */
+class SchedulingQueue
+{
+public:
+    /**
+     * @brief SchedulingQueue. Constructor
+     * @param pJM. Pointer to the JobManager, which owns the queue
+     */
+    SchedulingQueue(JobManager* pJM);
+
+    /**
+     * @brief count. Returns the number of waiting jobs
+     * @return number of waiting jobs
+     */
+    int count() const;
+    /**
+     * @brief jobIndex. Returns the index of the job at the given position in the queue
+     * @param iPos. Position in the queue
+     * @return index of the job in the JobManager
+     */
+    int jobIndex(int iPos) const;
+    /**
+     * @brief job. Returns the job at the given position in the queue
+     * @param iPos. Position in the queue
+     * @return pointer to the job
+     */
+    AbstractJob* job(int iPos) const;
+    /**
+     * @brief isReady. Checks, if the job at the given position in the queue can be
+     * started. This also checks the release window, if ordered release is on
+     * @param iPos. Position in the queue
+     * @return true, if the job can be started and false otherwise
+     */
+    bool isReady(int iPos) const;
+    /**
+     * @brief cost. Returns the estimated processing time of the job at the given
+     * position in the queue (see AbstractJob::setCost()). The costs are only kept up
+     * to date for the policies, which need them (see AbstractSchedulingPolicy::needsCosts())
+     * @param iPos. Position in the queue
+     * @return estimated processing time in [ms]
+     */
+    double cost(int iPos) const;
+    /**
+     * @brief rank. Returns the upward rank of the job at the given position in the
+     * queue, which is the length of the longest path through the dependency graph
+     * starting with this job (see JobManager::rank()). The ranks are only kept up to
+     * date for the policies, which need them (see AbstractSchedulingPolicy::needsRanks())
+     * @param iPos. Position in the queue
+     * @return upward rank in [ms]
+     */
+    double rank(int iPos) const;
+    /**
+     * @brief idleThreads. Returns the slot indices of the idle threads in the order
+     * they became idle. The selected job will be processed by one of them
+     * @return slot indices of the idle threads
+     */
+    QVector<int> idleThreads() const;
+
+private:
+    /**
+     * @brief m_pJM. Pointer to the JobManager, which owns the queue
+     */
+    JobManager* m_pJM;
+};
+
+/**
+ * @brief The AbstractSchedulingPolicy class. This is the base class for all the
+ * scheduling policies, which decide which waiting job is started next and which idle
+ * thread processes it.
+ *
+ * @details Every time a thread becomes idle, JobManager calls selectJob() to pick one
+ * of the ready jobs from the queue and then selectThread() to pick one of the idle
+ * threads for it. The threads are identified by their slot index, which does not
+ * change when a thread is replaced by the watchdog. Since JobManager keeps a single
+ * queue for all the threads, the order in which selectJob() picks the jobs is also
+ * the order, in which the threads take over the waiting work. <br/><br/>
+ * Both methods are called from the JobManager's thread with the JobManager locked, so
+ * they should be fast and they must not call JobManager methods. A policy object
+ * should not be shared between several JobManager objects.
+ */
+class AbstractSchedulingPolicy
+{
+public:
+    /**
+     * @brief ~AbstractSchedulingPolicy. Destructor
+     */
+    virtual ~AbstractSchedulingPolicy();
+
+    /**
+     * @brief selectJob. Reimplement this method to select the job, which is started
+     * next
+     * @param queue. Queue of the waiting jobs
+     * @return position of the selected job in the queue or -1, if no job is ready
+     */
+    virtual int selectJob(const SchedulingQueue& queue) = 0;
+    /**
+     * @brief selectThread. Reimplement this method to select the idle thread, which
+     * processes the selected job. The default implementation selects the thread,
+     * which has been idle the longest.
+     * @param pJob. Pointer to the selected job
+     * @param vIdle. Slot indices of the idle threads in the order they became idle.
+     * It is never empty
+     * @return position of the selected thread in vIdle
+     */
+    virtual int selectThread(const AbstractJob* pJob, const QVector<int>& vIdle);
+    /**
+     * @brief reset. Reimplement this method to forget the state kept from the previous
+     * processing. It is called by JobManager::start() and when the policy is set.
+     * The default implementation does nothing.
+     */
+    virtual void reset();
+    /**
+     * @brief needsCosts. Reimplement this method to return true, if selectJob() uses
+     * SchedulingQueue::cost(). JobManager then estimates the costs of the jobs added
+     * during the processing before it calls selectJob()
+     * @return true, if the policy uses the costs. The default implementation returns false
+     */
+    virtual bool needsCosts() const;
+    /**
+     * @brief needsRanks. Reimplement this method to return true, if selectJob() uses
+     * SchedulingQueue::rank(). JobManager then computes the ranks again after jobs were
+     * added, before it calls selectJob()
+     * @return true, if the policy uses the ranks. The default implementation returns false
+     */
+    virtual bool needsRanks() const;
+};
+
+}   // namespace
+
+#endif // ABSTRACTSCHEDULINGPOLICY_H
@@ -1,9 +1,16 @@
 #include <QDebug>
+#include <QDataStream>
 
 #include "abstractsessionmanager.h"
 
 namespace thr {
 
+static const quint32 s_uiCheckpointMagic = 0x54484a4e;
+static const qint32 s_iCheckpointVersion = 1;
+// header: magic and version; record: type, session index and value
+static const qint64 s_iHeaderSize = 8;
+static const qint64 s_iRecordSize = 9;
+
 //-----------------------------------------------------------------------------
 
 AbstractSessionManager::AbstractSessionManager(int iThreads, QObject* pParent) :
@@ -13,13 +20,18 @@ AbstractSessionManager::AbstractSessionManager(int iThreads, QObject* pParent) :
     m_iSessionIndex = -1;
     m_iSessionTimeout = 0;
     m_eStatus = sFinished;
+    m_bPaused = false;
+    m_bSessionPending = false;
+    m_bCheckpointJobs = false;
 
     m_jm.setReportJobFinish(true);
+    m_jm.cancellationToken().setParent(&m_token);
     connect(&m_jm, SIGNAL(signalFinished()), this, SLOT(handleFinished()));
     connect(&m_jm, SIGNAL(signalError(thr::JobManagerError)), this, SLOT(handleError(thr::JobManagerError)));
     connect(&m_jm, SIGNAL(signalStopped()), this, SLOT(handleStopped()));
     connect(&m_jm, SIGNAL(signalProgress(int)), this, SLOT(handleProgress(int)));
-    connect(&m_jm, SIGNAL(signalJobFinished(QSharedPointer<thr::AbstractJob>)), this, SLOT(handleJobFinished()));
+    connect(&m_jm, SIGNAL(signalJobFinished(thr::JobPointer)), this, SLOT(handleJobFinished()));
+    connect(&m_jm, SIGNAL(signalJobFinished(thr::JobPointer)), this, SLOT(recordJob(thr::JobPointer)));
 }
 
 //-----------------------------------------------------------------------------
@@ -38,6 +50,13 @@ void AbstractSessionManager::appendJob(AbstractJob* pJob)
 
 //-----------------------------------------------------------------------------
 
+void AbstractSessionManager::appendJobs(const QVector<AbstractJob*>& vpJobs)
+{
+    m_jm.appendJobs(vpJobs);
+}
+
+//-----------------------------------------------------------------------------
+
 void AbstractSessionManager::addThreads(int iT)
 {
     m_jm.addThreads(iT);
@@ -52,12 +71,40 @@ int AbstractSessionManager::threadsRunningCount() const
 
 //-----------------------------------------------------------------------------
 
+void AbstractSessionManager::setCheckpointFile(const QString& qsFile, bool bJobs)
+{
+    if (isRunning() == true) {
+        qWarning() << "Cannot set the checkpoint file, when the session manager is running!";
+        return;
+    }
+    m_fileCheckpoint.close();
+    m_qsCheckpoint = qsFile;
+    m_bCheckpointJobs = bJobs;
+}
+
+//-----------------------------------------------------------------------------
+
+void AbstractSessionManager::removeCheckpoint()
+{
+    if ((isRunning() == true) || (m_qsCheckpoint.isEmpty() == true)) {
+        return;
+    }
+    m_fileCheckpoint.close();
+    QFile::remove(m_qsCheckpoint);
+}
+
+//-----------------------------------------------------------------------------
+
 bool AbstractSessionManager::start()
 {
     if (isRunning() == true) {
         qWarning() << "Cannot start session manager, when it is already running!";
         return false;
     }
+    // a pause ends with the processing it paused, e.g. when it was stopped meanwhile
+    m_bPaused = false;
+    m_bSessionPending = false;
+    m_jm.resume();
 
     if (sessionCount() == 0) {
         qWarning() << "No sessions to process!";
@@ -68,6 +115,21 @@ bool AbstractSessionManager::start()
 
     m_iSessionIndex = 0;
     m_iFinished = 0;
+    if (openCheckpoint() == false) {
+        m_eStatus = sError;
+        emit signalError(m_iSessionIndex, jmeCouldNotStart);
+        return false;
+    }
+    if (m_iSessionIndex >= sessionCount()) {
+        // everything was done before the interruption
+        removeCheckpoint();
+        m_eStatus = sFinished;
+        emit signalFinished();
+        return true;
+    }
+    m_token.reset();
+    // the job manager stays stopped after the previous run until it is started again
+    m_jm.cancellationToken().reset();
     m_eStatus = sPaused;
     startNextSession();
     return m_eStatus == sRunning;
@@ -82,6 +144,32 @@ void AbstractSessionManager::stop()
     }   else {
         handleStopped();
     }
+    // the job manager stays cancelled even when it is cleared for the next session
+    m_token.cancel();
+    m_bSessionPending = false;
+}
+
+//-----------------------------------------------------------------------------
+
+void AbstractSessionManager::pause()
+{
+    m_bPaused = true;
+    m_jm.pause();
+}
+
+//-----------------------------------------------------------------------------
+
+void AbstractSessionManager::resume()
+{
+    if (m_bPaused == false) {
+        return;
+    }
+    m_bPaused = false;
+    m_jm.resume();
+    if (m_bSessionPending == true) {
+        m_bSessionPending = false;
+        startNextSession();
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -95,11 +183,15 @@ void AbstractSessionManager::handleFinished()
     }
 
     m_eStatus = sPaused;
+    writeRecord(rtSession, m_iFinished);
     emit signalSessionFinished(m_iSessionIndex);
     ++m_iSessionIndex;
     if (m_iSessionIndex < sessionCount()) {
         QTimer::singleShot(m_iSessionTimeout, this, SLOT(startNextSession()));
     }   else {
+        if (m_fileCheckpoint.isOpen() == true) {
+            m_fileCheckpoint.remove();
+        }
         m_eStatus = sFinished;
         emit signalFinished();
     }
@@ -109,6 +201,8 @@ void AbstractSessionManager::handleFinished()
 
 void AbstractSessionManager::handleError(thr::JobManagerError eJME)
 {
+    // the checkpoint file is kept, so the processing can be resumed
+    m_fileCheckpoint.close();
     m_eStatus = sError;
     emit signalError(m_iSessionIndex, eJME);
     m_iSessionIndex = -1;
@@ -118,6 +212,7 @@ void AbstractSessionManager::handleError(thr::JobManagerError eJME)
 
 void AbstractSessionManager::handleStopped()
 {
+    m_fileCheckpoint.close();
     m_eStatus = sStopped;
     emit signalStopped(m_iSessionIndex);
     m_iSessionIndex = -1;
@@ -143,12 +238,32 @@ void AbstractSessionManager::handleJobFinished()
 void AbstractSessionManager::startNextSession()
 {
     if (m_jm.isStopped() == true) {
-        handleStopped();
+        if (m_eStatus != sStopped) {
+            handleStopped();
+        }
+        return;
+    }
+    if (m_bPaused == true) {
+        // resume() starts the session
+        m_bSessionPending = true;
         return;
     }
     m_jm.clear();
     m_jm.setAllowedErrors(allowedErrors());
     initNextSession();
+    m_hashJobIndex.clear();
+    if (m_bCheckpointJobs == true) {
+        for (int i = 0; i < m_jm.jobCount(); ++i) {
+            m_hashJobIndex.insert(m_jm.job(i).data(), i);
+        }
+    }
+    // the jobs finished before the interruption are not processed again
+    for (int i = 0; (i < m_jm.jobCount()) && (m_setRestored.isEmpty() == false); ++i) {
+        if (m_setRestored.remove(i) == true) {
+            m_jm.markFinished(i);
+        }
+    }
+    m_setRestored.clear();
     m_eStatus = sRunning;
     if (m_jm.start() == false) {
         m_eStatus = sError;
@@ -158,5 +273,101 @@ void AbstractSessionManager::startNextSession()
 
 //-----------------------------------------------------------------------------
 
+void AbstractSessionManager::recordJob(thr::JobPointer spJob)
+{
+    if (
+            (m_bCheckpointJobs == false) || (spJob.isNull() == true) ||
+            (spJob->isFinished() == false) ||
+            (m_hashJobIndex.contains(spJob.data()) == false)
+            ) {
+        // spawned jobs are not recorded, since they cannot be recreated
+        return;
+    }
+    writeRecord(rtJob, m_hashJobIndex.value(spJob.data()));
+}
+
+//-----------------------------------------------------------------------------
+
+bool AbstractSessionManager::openCheckpoint()
+{
+    m_fileCheckpoint.close();
+    m_setRestored.clear();
+    if (m_qsCheckpoint.isEmpty() == true) {
+        return true;
+    }
+
+    m_fileCheckpoint.setFileName(m_qsCheckpoint);
+    if (m_fileCheckpoint.open(QIODevice::ReadWrite) == false) {
+        qWarning() << "Could not open the checkpoint file" << m_qsCheckpoint;
+        return false;
+    }
+
+    QDataStream ds(&m_fileCheckpoint);
+    ds.setVersion(QDataStream::Qt_5_0);
+    if (m_fileCheckpoint.size() == 0) {
+        // a new file; the processing starts with the first session
+        ds << s_uiCheckpointMagic << s_iCheckpointVersion;
+        m_fileCheckpoint.flush();
+        return ds.status() == QDataStream::Ok;
+    }
+
+    quint32 uiMagic = 0;
+    qint32 iVersion = 0;
+    ds >> uiMagic >> iVersion;
+    if (
+            (ds.status() != QDataStream::Ok) || (uiMagic != s_uiCheckpointMagic) ||
+            (iVersion != s_iCheckpointVersion)
+            ) {
+        // the file is not a journal this version can read, so it is left as it is
+        qWarning() << "Not a usable checkpoint file" << m_qsCheckpoint;
+        m_fileCheckpoint.close();
+        return false;
+    }
+
+    qint64 iGood = s_iHeaderSize;
+    int iSessionFinished = 0;
+    while (m_fileCheckpoint.size() - iGood >= s_iRecordSize) {
+        qint8 iType = 0;
+        qint32 iSession = 0;
+        qint32 iValue = 0;
+        ds >> iType >> iSession >> iValue;
+        if (ds.status() != QDataStream::Ok) {
+            break;
+        }
+        if ((iType == rtSession) && (iSession >= m_iSessionIndex)) {
+            m_iSessionIndex = iSession + 1;
+            iSessionFinished = iValue;
+            m_setRestored.clear();
+        }   else if ((iType == rtJob) && (iSession == m_iSessionIndex)) {
+            m_setRestored.insert(iValue);
+        }   else if ((iType != rtSession) && (iType != rtJob)) {
+            break;
+        }
+        iGood += s_iRecordSize;
+    }
+    m_iFinished = iSessionFinished + m_setRestored.count();
+
+    // a record torn by the interruption is cut off, so the new records follow the good ones
+    m_fileCheckpoint.resize(iGood);
+    m_fileCheckpoint.seek(iGood);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void AbstractSessionManager::writeRecord(RecordType eType, int iValue)
+{
+    if (m_fileCheckpoint.isOpen() == false) {
+        return;
+    }
+    QDataStream ds(&m_fileCheckpoint);
+    ds.setVersion(QDataStream::Qt_5_0);
+    ds << static_cast<qint8>(eType) << static_cast<qint32>(m_iSessionIndex)
+       << static_cast<qint32>(iValue);
+    m_fileCheckpoint.flush();
+}
+
+//-----------------------------------------------------------------------------
+
 }   // namespace
 
@@ -12,6 +12,9 @@
  ************************************************************************************/
 
 #include <QMutex>
+#include <QFile>
+#include <QSet>
+#include <QHash>
 
 #include "jobmanager.h"
 
@@ -124,7 +127,14 @@ protected slots:
  * @endcode
  * Instead of waiting in the event processing loop until the session manager is finished,
  * one can also connect to the session manager signalFinished, which will be emitted
- * after all sessions are finished.
+ * after all sessions are finished. <br/><br/>
+ * If a checkpoint file is set with setCheckpointFile(), every finished session (and
+ * optionally every finished job) is appended to this file. If the processing is
+ * interrupted by a crash or by stop(), the next start() reads the file and resumes with
+ * the first unfinished session, skipping the jobs already finished in it. For the job
+ * checkpoints to work, initNextSession() has to create the same jobs in the same order
+ * every time it is called for a session. The file is removed, when all the sessions
+ * are finished.
  */
 class AbstractSessionManager : public QObject
 {
@@ -179,6 +189,12 @@ public:
      */
     bool isFinished() const
     {   return m_eStatus == sFinished; }
+    /**
+     * @brief isPaused. Returns true, if the processing was paused with pause()
+     * @return true, if the processing is paused and false otherwise
+     */
+    bool isPaused() const
+    {   return m_bPaused; }
     /**
      * @brief currentSession. Returns the current session index
      * @return current session index
@@ -193,11 +209,49 @@ public:
     void setSessionTimeout(int iTime)
     {   m_iSessionTimeout = iTime; }
     /**
-     * @brief finishedJobs. Returns the total number of finished jobs
+     * @brief setJobTimeout. Sets the deadline for processing of every job, which has
+     * no deadline of its own. A job exceeding the deadline is stopped and counted as
+     * failed, so one hung job cannot stall all the remaining sessions.
+     * @param iMS. Deadline in [ms]. If it is 0 or negative, jobs are not watched
+     */
+    void setJobTimeout(int iMS)
+    {   m_jm.setJobTimeout(iMS); }
+    /**
+     * @brief setResultCache. Sets the cache for the results of the deterministic jobs
+     * of all the sessions (see JobManager::setResultCache())
+     * @param pCache. Pointer to the result cache, which is not owned by the session manager
+     */
+    void setResultCache(ResultCache* pCache)
+    {   m_jm.setResultCache(pCache); }
+    /**
+     * @brief finishedJobs. Returns the total number of finished jobs, including the
+     * jobs, which failed, expired or were skipped (see JobManager::signalJobFinished())
      * @return total number of finished jobs
      */
     int finishedJobs() const
     {   return m_iFinished; }
+    /**
+     * @brief setCheckpointFile. Sets the file, where the progress is recorded, so the
+     * processing can be resumed from it after an interruption. It has to be set
+     * before start() is called
+     * @param qsFile. Name of the checkpoint file. If it is empty, no checkpoints are made.
+     * If the file exists and is not a checkpoint file of the current version, start()
+     * fails with jmeCouldNotStart and the file is left as it is
+     * @param bJobs. If true, every successfully finished job is recorded as well, so an
+     * interrupted session does not have to be processed from its beginning
+     */
+    void setCheckpointFile(const QString& qsFile, bool bJobs = false);
+    /**
+     * @brief checkpointFile. Returns the name of the checkpoint file
+     * @return name of the checkpoint file or an empty string, if there is none
+     */
+    QString checkpointFile() const
+    {   return m_qsCheckpoint; }
+    /**
+     * @brief removeCheckpoint. Removes the checkpoint file, so the next start() begins
+     * with the first session. It has no effect while the session manager is running
+     */
+    void removeCheckpoint();
     /**
      * @brief appendJob. Appends the job to the current session
      * @param pJob. Pointer to the new job, which will be added to the
@@ -205,6 +259,12 @@ public:
      * object!
      */
     void appendJob(thr::AbstractJob* pJob);
+    /**
+     * @brief appendJobs. Appends all the given jobs to the current session at once
+     * @param vpJobs. Vector of pointers to the new jobs, which will be added to the
+     * current session. AbstractSessionManager takes ownership of these objects!
+     */
+    void appendJobs(const QVector<thr::AbstractJob*>& vpJobs);
     /**
      * @brief addThreads. Adds iT threads for execution to the internal job manager
      * object. This method can be called even in the middle of processing.
@@ -228,9 +288,20 @@ public slots:
      */
     virtual bool start();
     /**
-     * @brief stop. Stops the job manager executing the current session
+     * @brief stop. Stops the job manager executing the current session. No further
+     * sessions are started until start() is called again
      */
     virtual void stop();
+    /**
+     * @brief pause. Pauses the processing of the current session (see
+     * JobManager::pause()). If a session finishes while paused, the next session is
+     * not started until resume() is called. The pause ends, when start() is called
+     */
+    virtual void pause();
+    /**
+     * @brief resume. Resumes the paused processing
+     */
+    virtual void resume();
 
 signals:
     /**
@@ -314,6 +385,38 @@ protected slots:
      */
     virtual void startNextSession();
 
+private slots:
+    /**
+     * @brief recordJob. Records the finished job into the checkpoint file
+     * @param spJob. Pointer to the finished job
+     */
+    void recordJob(thr::JobPointer spJob);
+
+private:
+    /**
+     * @brief The RecordType enum. Types of the checkpoint file records
+     */
+    enum RecordType {
+        rtSession = 1,          //!< a session is finished; value is the total number of finished jobs
+        rtJob = 2,              //!< a job is finished; value is the job index within the session
+    };
+    /**
+     * @brief openCheckpoint. Opens the checkpoint file and restores the session index,
+     * the number of finished jobs and the jobs finished in the interrupted session
+     * from it. A torn record at the end of the file is cut off. Only an empty or a new
+     * file is initialized; any other file is never overwritten
+     * @return true, if the checkpoint file is ready for recording or no checkpoint
+     * file is set, and false, if the file could not be opened or is not a checkpoint
+     * file of the current version
+     */
+    bool openCheckpoint();
+    /**
+     * @brief writeRecord. Appends a record to the checkpoint file and flushes it
+     * @param eType. Type of the record
+     * @param iValue. Value of the record
+     */
+    void writeRecord(RecordType eType, int iValue);
+
 protected:
     /**
      * @brief m_eStatus. This variable denotes the current status of the object
@@ -337,6 +440,44 @@ protected:
      * @brief m_iFinished. Contains the number of finished jobs
      */
     int m_iFinished;
+
+private:
+    /**
+     * @brief m_token. Cancellation token of the session manager. The token of the
+     * job manager is its child, so stopping the session manager reaches the running
+     * jobs at once.
+     */
+    CancellationToken m_token;
+    /**
+     * @brief m_bPaused. Set to true, while the processing is paused by the user
+     */
+    bool m_bPaused;
+    /**
+     * @brief m_bSessionPending. Set to true, if the next session should have been
+     * started while the processing was paused
+     */
+    bool m_bSessionPending;
+    /**
+     * @brief m_qsCheckpoint. Name of the checkpoint file
+     */
+    QString m_qsCheckpoint;
+    /**
+     * @brief m_bCheckpointJobs. If true, the finished jobs are recorded as well
+     */
+    bool m_bCheckpointJobs;
+    /**
+     * @brief m_fileCheckpoint. Opened checkpoint file
+     */
+    QFile m_fileCheckpoint;
+    /**
+     * @brief m_setRestored. Indices of the jobs of the current session, which were
+     * finished before the interruption
+     */
+    QSet<int> m_setRestored;
+    /**
+     * @brief m_hashJobIndex. Indices of the current session jobs within the session
+     */
+    QHash<const AbstractJob*, int> m_hashJobIndex;
 };
 
 }   // namespace
@@ -0,0 +1,167 @@
+#include <QDebug>
+#include <QElapsedTimer>
+
+#include "cancellationtoken.h"
+
+namespace thr {
+
+//-----------------------------------------------------------------------------
+
+CancellationToken::CancellationToken()
+{
+    m_pParent.storeRelease(nullptr);
+    m_iNextCallback = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+CancellationToken::~CancellationToken()
+{
+    detach();
+    QMutexLocker locker(&m_mutex);
+    for (int i = 0; i < m_vpChildren.count(); ++i) {
+        m_vpChildren[i]->m_pParent.storeRelease(nullptr);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void CancellationToken::cancel()
+{
+    QVector<std::function<void()> > vCallbacks;
+    cancelTree(vCallbacks);
+
+    for (int i = 0; i < vCallbacks.count(); ++i) {
+        vCallbacks[i]();
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void CancellationToken::reset()
+{
+    CancellationToken* pParent = m_pParent.loadAcquire();
+    if (pParent == nullptr) {
+        m_iCancelled.storeRelease(0);
+        return;
+    }
+    // the parent's lock is held while the parent cancels its children
+    QMutexLocker locker(&pParent->m_mutex);
+    if (pParent->isCancelled() == false) {
+        m_iCancelled.storeRelease(0);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void CancellationToken::setParent(CancellationToken* pParent)
+{
+    detach();
+    if (pParent == nullptr) {
+        return;
+    }
+
+    QVector<std::function<void()> > vCallbacks;
+    QMutexLocker locker(&pParent->m_mutex);
+    pParent->m_vpChildren.append(this);
+    m_pParent.storeRelease(pParent);
+    if (pParent->isCancelled() == true) {
+        cancelTree(vCallbacks);
+    }
+    locker.unlock();
+
+    for (int i = 0; i < vCallbacks.count(); ++i) {
+        vCallbacks[i]();
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+CancellationToken* CancellationToken::parent() const
+{
+    return m_pParent.loadAcquire();
+}
+
+//-----------------------------------------------------------------------------
+
+int CancellationToken::addCallback(const std::function<void()>& fnCallback)
+{
+    QMutexLocker locker(&m_mutex);
+    int iId = m_iNextCallback++;
+    m_vCallbacks.append(qMakePair(iId, fnCallback));
+    if (isCancelled() == true) {
+        locker.unlock();
+        fnCallback();
+    }
+    return iId;
+}
+
+//-----------------------------------------------------------------------------
+
+void CancellationToken::removeCallback(int iId)
+{
+    QMutexLocker locker(&m_mutex);
+    for (int i = 0; i < m_vCallbacks.count(); ++i) {
+        if (m_vCallbacks[i].first == iId) {
+            m_vCallbacks.removeAt(i);
+            return;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+bool CancellationToken::wait(int iMS) const
+{
+    QMutexLocker locker(&m_mutex);
+    if (iMS < 0) {
+        while (isCancelled() == false) {
+            m_cond.wait(&m_mutex);
+        }
+        return true;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 iLeft = iMS;
+    while ((isCancelled() == false) && (iLeft > 0)) {
+        m_cond.wait(&m_mutex, static_cast<unsigned long>(iLeft));
+        iLeft = iMS - timer.elapsed();
+    }
+    return isCancelled();
+}
+
+//-----------------------------------------------------------------------------
+
+void CancellationToken::cancelTree(QVector<std::function<void()> >& rvCallbacks)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_iCancelled.testAndSetOrdered(0, 1) == false) {
+        // already cancelled, so are all the descendants
+        return;
+    }
+    m_cond.wakeAll();
+
+    for (int i = 0; i < m_vCallbacks.count(); ++i) {
+        rvCallbacks.append(m_vCallbacks[i].second);
+    }
+    for (int i = 0; i < m_vpChildren.count(); ++i) {
+        m_vpChildren[i]->cancelTree(rvCallbacks);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void CancellationToken::detach()
+{
+    CancellationToken* pParent = m_pParent.loadAcquire();
+    if (pParent != nullptr) {
+        QMutexLocker locker(&pParent->m_mutex);
+        pParent->m_vpChildren.removeOne(this);
+        m_pParent.storeRelease(nullptr);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+}   // namespace
@@ -0,0 +1,173 @@
+#ifndef CANCELLATIONTOKEN_H
+#define CANCELLATIONTOKEN_H
+
+/************************************************************************************
+ *                                                                                  *
+ *  Project:     ThreadingLib                                                       *
+ *  File:        cancellationtoken.h                                                *
+ *  Class:       CancellationToken                                                  *
+ *  Author:      Bojan Kverh                                                        *
+ *  License:     LGPL                                                               *
+ *                                                                                  *
+ ************************************************************************************/
+
+#include <functional>
+
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include <QMutex>
+#include <QPair>
+#include <QVector>
+#include <QWaitCondition>
+
+namespace thr {
+
+/**
+ * @brief The CancellationToken class. This class is used to request cooperative
+ * cancellation of processing from another thread.
+ *
+ * @details The cancellation state is held in an atomic flag, so isCancelled() can be
+ * polled as often as needed from any thread at the cost of a single atomic load.
+ * <br/><br/>
+ * Tokens form a hierarchy: when a token is cancelled, all its child tokens
+ * (and their children) are cancelled as well. AbstractSessionManager's token is the
+ * parent of its JobManager's token, which is in turn the parent of the tokens of all
+ * the jobs it is processing, so stopping a session manager or a job manager reaches
+ * every running job at once. <br/><br/>
+ * Code, which blocks, can be woken up on cancellation either by waiting on the
+ * token itself with wait() instead of sleeping, or by registering a callback with
+ * addCallback(), which is called when the token is cancelled, e.g. in order to wake a
+ * wait condition the job is blocked on. Callbacks are called in the thread, which
+ * cancelled the token, after all the tokens in the hierarchy have been cancelled.
+ * <br/><br/>
+ * Every token has its own lock, which guards its children and callbacks, so tokens of
+ * different job managers never contend. Attaching a token locks only its parent.
+ */
+class CancellationToken
+{
+public:
+    /**
+     * @brief CancellationToken. Default constructor. The token is not cancelled and
+     * has no parent.
+     */
+    CancellationToken();
+    /**
+     * @brief ~CancellationToken. Destructor. Detaches the token from its parent
+     * and from its children
+     */
+    ~CancellationToken();
+
+    /**
+     * @brief isCancelled. Returns true, if the token or any of its ancestors has
+     * been cancelled
+     * @return true, if the token has been cancelled and false otherwise
+     */
+    bool isCancelled() const
+    {   return m_iCancelled.loadAcquire() != 0; }
+    /**
+     * @brief cancel. Cancels this token and all its descendants, wakes up all the
+     * threads waiting on any of them and calls all the registered callbacks.
+     * Cancelling a token, which is already cancelled, does nothing.
+     */
+    void cancel();
+    /**
+     * @brief reset. Clears the cancelled flag of this token, unless its parent is
+     * cancelled. Descendants are not affected.
+     */
+    void reset();
+
+    /**
+     * @brief setParent. Attaches the token to the given parent token. If the parent
+     * is already cancelled, this token is cancelled immediately.
+     * @param pParent. Pointer to the new parent token. If it is nullptr, the token
+     * is only detached from its current parent. The parent token has to outlive
+     * this token or the token has to be detached from it in time.
+     */
+    void setParent(CancellationToken* pParent);
+    /**
+     * @brief parent. Returns the pointer to the parent token
+     * @return pointer to the parent token or nullptr, if this token has no parent
+     */
+    CancellationToken* parent() const;
+
+    /**
+     * @brief addCallback. Registers the callback, which will be called when the token
+     * is cancelled. If the token is already cancelled, the callback is called
+     * immediately. The callback is called in the thread, which cancelled the token
+     * (or its ancestor), without holding any lock of the tokens. When a JobManager is
+     * stopped, the callbacks of its jobs are called in the thread calling
+     * JobManager::stop() without the JobManager being locked. When the JobManager
+     * stops a single job (an exceeded deadline, a dropped dependent or a losing
+     * duplicate), they are called in the JobManager's thread while it is locked, so
+     * they should not call the JobManager then.
+     * @param fnCallback. Callback function
+     * @return identifier of the callback, which can be used to remove it
+     */
+    int addCallback(const std::function<void()>& fnCallback);
+    /**
+     * @brief removeCallback. Removes the callback with the given identifier
+     * @param iId. Callback identifier, returned by addCallback()
+     */
+    void removeCallback(int iId);
+
+    /**
+     * @brief wait. Blocks the calling thread until the token is cancelled or until
+     * the timeout expires. Use this instead of sleeping inside the process() method
+     * to make sure that the job reacts to the stop request without delay.
+     * @param iMS. Timeout in [ms]. If it is negative, the method waits until the
+     * token is cancelled.
+     * @return true, if the token has been cancelled and false otherwise
+     */
+    bool wait(int iMS = -1) const;
+
+private:
+    /**
+     * @brief cancelTree. Cancels this token and all its descendants. The lock of a token
+     * is always taken before the locks of its children. Callbacks of the cancelled
+     * tokens are appended to the vector.
+     * @param rvCallbacks. Vector of callbacks to call after all the locks are released
+     */
+    void cancelTree(QVector<std::function<void()> >& rvCallbacks);
+    /**
+     * @brief detach. Detaches this token from its parent
+     */
+    void detach();
+
+    Q_DISABLE_COPY(CancellationToken)
+
+private:
+    /**
+     * @brief m_mutex. Synchronization object, which guards the children and the
+     * callbacks of this token
+     */
+    mutable QMutex m_mutex;
+    /**
+     * @brief m_cond. Wait condition, which is woken up when this token is cancelled
+     */
+    mutable QWaitCondition m_cond;
+
+    /**
+     * @brief m_iCancelled. Cancelled flag
+     */
+    QAtomicInt m_iCancelled;
+    /**
+     * @brief m_pParent. Pointer to the parent token
+     */
+    QAtomicPointer<CancellationToken> m_pParent;
+    /**
+     * @brief m_vpChildren. Pointers to the child tokens
+     */
+    QVector<CancellationToken*> m_vpChildren;
+    /**
+     * @brief m_vCallbacks. Registered callbacks with their identifiers
+     */
+    QVector<QPair<int, std::function<void()> > > m_vCallbacks;
+    /**
+     * @brief m_iNextCallback. Identifier of the next registered callback
+     */
+    int m_iNextCallback;
+};
+
+}   // namespace
+
+#endif // CANCELLATIONTOKEN_H
@@ -0,0 +1,307 @@
+#ifndef DATAPORT_H
+#define DATAPORT_H
+
+/************************************************************************************
+ *                                                                                  *
+ *  Project:     ThreadingLib                                                       *
+ *  File:        dataport.h                                                         *
+ *  Class:       AbstractInputPort, OutputPort, InputPort                           *
+ *  Author:      Bojan Kverh                                                        *
+ *  License:     LGPL                                                               *
+ *                                                                                  *
+ ************************************************************************************/
+
+#include <utility>
+
+#include <QtGlobal>
+#include <QAtomicInt>
+#include <QScopedPointer>
+#include <QSharedPointer>
+
+#include "abstractjob.h"
+
+namespace thr {
+
+/**
+ * @brief The PortSlot struct. Holds the value passed from an OutputPort to its
+ * InputPorts. It is shared by the output and all the connected inputs
+ */
+template <typename T>
+struct PortSlot
+{
+    PortSlot() : m_iConsumers(0)
+    {   }
+
+    QScopedPointer<T> m_pValue;     //!< the value or null pointer, if it was not set or was released
+    int m_iConsumers;               //!< number of connected inputs
+    QAtomicInt m_iPending;          //!< number of inputs, which have not released the value yet
+};
+
+/**
+ * @brief The AbstractInputPort class. This is the base class of all input ports. It
+ * registers the port with its job, so the job can release the port, when it is finished
+ */
+class AbstractInputPort
+{
+public:
+    /**
+     * @brief AbstractInputPort. Constructor
+     * @param pOwner. Pointer to the job, which owns this port
+     */
+    explicit AbstractInputPort(AbstractJob* pOwner) : m_pOwner(pOwner), m_pProducer(nullptr)
+    {   m_pOwner->m_vpInputPorts.append(this); }
+    /**
+     * @brief ~AbstractInputPort. Destructor
+     */
+    virtual ~AbstractInputPort()
+    {   }
+    /**
+     * @brief owner. Returns the job, which owns this port
+     * @return pointer to the job
+     */
+    AbstractJob* owner() const
+    {   return m_pOwner; }
+    /**
+     * @brief producer. Returns the job, which owns the output connected to this port
+     * @return pointer to the producing job or null pointer, if the port is not connected
+     */
+    AbstractJob* producer() const
+    {   return m_pProducer; }
+    /**
+     * @brief isConnected. Returns true, if the input is connected to an output
+     * @return true, if the input is connected and false otherwise
+     */
+    bool isConnected() const
+    {   return m_pProducer != nullptr; }
+    /**
+     * @brief hasValue. Returns true, if the value can be read from this input
+     * @return true, if the value was set by the producing job and was not freed yet
+     */
+    virtual bool hasValue() const = 0;
+    /**
+     * @brief release. Called, when the owner job finished successfully, so the value
+     * can be freed, if no other job needs it anymore
+     */
+    virtual void release() = 0;
+
+protected:
+    /**
+     * @brief setProducer. Sets the job, which owns the output connected to this port
+     * @param pProducer. Pointer to the producing job
+     */
+    void setProducer(AbstractJob* pProducer)
+    {   m_pProducer = pProducer; }
+
+private:
+    /**
+     * @brief m_pOwner. Pointer to the job, which owns this port
+     */
+    AbstractJob* m_pOwner;
+    /**
+     * @brief m_pProducer. Pointer to the job, which owns the connected output
+     */
+    AbstractJob* m_pProducer;
+};
+
+/**
+ * @brief The OutputPort class. A job passes its result of type T to the jobs depending
+ * on it through an output port.
+ *
+ * @details The port is a member of the producing job, constructed with the pointer to
+ * that job. The consuming jobs have an InputPort<T> member each, connected to the output
+ * port with InputPort::connect(), which also adds the dependency. The producer moves
+ * its result into the port with set(); the consumers read it without copying. When the
+ * last consumer is finished, the value is freed, so the memory of the intermediate
+ * results is reclaimed while the rest of the graph is still being processed. <br/><br/>
+ * When a freed value is needed again, because a consumer was invalidated (see
+ * JobManager::invalidate()), the producer is processed again as well. A producer
+ * taking part in result caching (see AbstractJob::cacheKey()) has to write the value
+ * of its output ports in saveResult() and set them again in loadResult(), since
+ * process() is not called, when the result is taken from the cache. <br/><br/>
+ * Example:
+ * @code
+class JobLoad : public thr::AbstractJob
+{
+public:
+    JobLoad() : thr::AbstractJob(), m_out(this)
+    {   }
+
+    thr::OutputPort<QVector<double>> m_out;
+
+protected:
+    void process()
+    {
+        QVector<double> vData;
+        // ... fill vData
+        m_out.set(std::move(vData));
+    }
+};
+
+class JobSum : public thr::AbstractJob
+{
+public:
+    JobSum() : thr::AbstractJob(), m_in(this)
+    {   }
+
+    thr::InputPort<QVector<double>> m_in;
+
+protected:
+    void process()
+    {
+        const QVector<double>& rvData = m_in.value();
+        // ... use rvData
+    }
+};
+
+    // the ports are wired before the jobs are started
+    pSum->m_in.connect(pLoad->m_out);
+ * @endcode
+ */
+template <typename T>
+class OutputPort
+{
+    template <typename U> friend class InputPort;
+
+public:
+    /**
+     * @brief OutputPort. Constructor
+     * @param pOwner. Pointer to the job, which owns this port
+     */
+    explicit OutputPort(AbstractJob* pOwner) :
+        m_pOwner(pOwner),
+        m_spSlot(new PortSlot<T>)
+    {   }
+    /**
+     * @brief owner. Returns the job, which owns this port
+     * @return pointer to the job
+     */
+    AbstractJob* owner() const
+    {   return m_pOwner; }
+    /**
+     * @brief set. Sets the value passed to the connected inputs. Call it from the
+     * process() method of the owner job
+     * @param value. The value, which is moved into the port
+     */
+    void set(T value)
+    {
+        m_spSlot->m_pValue.reset(new T(std::move(value)));
+        m_spSlot->m_iPending.storeRelease(m_spSlot->m_iConsumers);
+    }
+    /**
+     * @brief hasValue. Returns true, if the value is set and was not freed yet
+     * @return true, if the value is set and false otherwise
+     */
+    bool hasValue() const
+    {   return m_spSlot->m_pValue.isNull() == false; }
+    /**
+     * @brief value. Returns the value set by the owner job, e.g. to write it in
+     * saveResult(). The port has to have a value (see hasValue())
+     * @return reference to the value
+     */
+    const T& value() const
+    {
+        Q_ASSERT(hasValue() == true);
+        return *m_spSlot->m_pValue;
+    }
+    /**
+     * @brief consumerCount. Returns the number of connected inputs
+     * @return number of connected inputs
+     */
+    int consumerCount() const
+    {   return m_spSlot->m_iConsumers; }
+
+private:
+    /**
+     * @brief m_pOwner. Pointer to the job, which owns this port
+     */
+    AbstractJob* m_pOwner;
+    /**
+     * @brief m_spSlot. The value shared with the connected inputs
+     */
+    QSharedPointer<PortSlot<T>> m_spSlot;
+};
+
+/**
+ * @brief The InputPort class. A job receives the result of type T of a job it depends
+ * on through an input port (see OutputPort)
+ */
+template <typename T>
+class InputPort : public AbstractInputPort
+{
+public:
+    /**
+     * @brief InputPort. Constructor
+     * @param pOwner. Pointer to the job, which owns this port
+     */
+    explicit InputPort(AbstractJob* pOwner) : AbstractInputPort(pOwner)
+    {   }
+    /**
+     * @brief connect. Connects this input to the output of another job and makes the
+     * owner job depend on that job. An input can only be connected once and all the
+     * inputs have to be connected before the producing job is started
+     * @param rOut. Output port of the producing job
+     */
+    void connect(OutputPort<T>& rOut)
+    {
+        if (m_spSlot.isNull() == false) {
+            return;
+        }
+        m_spSlot = rOut.m_spSlot;
+        ++m_spSlot->m_iConsumers;
+        setProducer(rOut.owner());
+        owner()->addDependency(JobPointer(rOut.owner()));
+    }
+    /**
+     * @brief hasValue. Returns true, if the value can be read from this input
+     * @return true, if the value was set by the producing job and false otherwise
+     */
+    bool hasValue() const
+    {   return (m_spSlot.isNull() == false) && (m_spSlot->m_pValue.isNull() == false); }
+    /**
+     * @brief value. Returns the value without copying it. The input has to have a
+     * value (see hasValue())
+     * @return reference to the value, which is valid until the owner job is finished
+     */
+    const T& value() const
+    {
+        Q_ASSERT(hasValue() == true);
+        return *m_spSlot->m_pValue;
+    }
+    /**
+     * @brief take. Returns the value. If no other consumer needs the value anymore,
+     * it is moved out of the port, otherwise it is copied. Since the value is gone
+     * after it is moved, the owner job should not fail after calling this method.
+     * The input has to have a value (see hasValue())
+     * @return the value
+     */
+    T take()
+    {
+        Q_ASSERT(hasValue() == true);
+        if (m_spSlot->m_iPending.loadAcquire() == 1) {
+            return std::move(*m_spSlot->m_pValue);
+        }
+        return *m_spSlot->m_pValue;
+    }
+    /**
+     * @brief release. Frees the value, if this was the last consumer needing it
+     */
+    void release()
+    {
+        if (
+                (hasValue() == true) &&
+                (m_spSlot->m_iPending.fetchAndAddOrdered(-1) == 1)
+                ) {
+            m_spSlot->m_pValue.reset();
+        }
+    }
+
+private:
+    /**
+     * @brief m_spSlot. The value shared with the connected output
+     */
+    QSharedPointer<PortSlot<T>> m_spSlot;
+};
+
+}   // namespace
+
+#endif // DATAPORT_H
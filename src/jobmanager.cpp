@@ -1,11 +1,17 @@
-#include <assert.h>
+#include <typeinfo>
+#include <algorithm>
 
 #include <QVariant>
+#include <QEventLoop>
 #include <QDebug>
 
 #include "jobmanager.h"
+#include "schedulingpolicies.h"
+#include "dataport.h"
 
 #define THREAD_INDEX            "thInd"
+#define SPECULATION_INTERVAL    20
+#define RUN_TIME_SAMPLES        1024
 
 namespace thr {
 
@@ -16,35 +22,175 @@ JobManager::JobManager(int iThreads, QObject* pParent) : QObject(pParent)
     m_timer.setInterval(0);
     m_iStarted = 0;
     m_iRunning = 0;
-    m_bStop = false;
+    m_iStopLatency = -1;
     m_bReportJobFinish = false;
+    m_bOrderedRelease = false;
+    m_iReleaseWindow = 0;
+    m_iReleased.storeRelease(0);
     m_eStatus = sFinished;
     m_eError = jmeNoError;
-    m_iFinished = 0;
+    m_iFinished.storeRelease(0);
     m_iAllowedErrors = 0;
+    m_eErrorPolicy = jepWait;
+    m_iDropped = 0;
+    m_iJobTimeout = 0;
+    m_iRetrying = 0;
+    m_iRetries = 0;
+    m_bSpeculation = false;
+    m_dSpeculationFactor = 3.0;
+    m_iSpeculationSamples = 5;
+    m_iSpeculated = 0;
+    m_iSpeculationWins = 0;
+    m_spPolicy = QSharedPointer<AbstractSchedulingPolicy>(new FifoPolicy);
+    m_iContinuationDepth.storeRelease(0);
+    m_iContinued = 0;
+    m_iWaitingDepth.storeRelease(0);
+    m_eIdleProfile = ipBalanced;
+    m_iOverflowPolicy.storeRelease(opQueue);
+    m_pCache = nullptr;
+    m_iMaxWaiting.storeRelease(0);
+    m_iInline = 0;
+    m_dTotalCost = 0.0;
+    m_dFinishedCost = 0.0;
+    m_bCostHints = false;
     if (iThreads <= 0) {
         iThreads = QThread::idealThreadCount();
     }
     allocateThreads(iThreads);
     connect(&m_timer, SIGNAL(timeout()), this, SLOT(reportProgress()));
+    connect(&m_timerWatchdog, SIGNAL(timeout()), this, SLOT(checkTimeouts()));
+    connect(&m_wheelRetry, SIGNAL(signalExpired(int)), this, SLOT(retryJob(int)));
 }
 
 //-----------------------------------------------------------------------------
 
 JobManager::~JobManager()
 {
+    // the threads must not continue with the jobs, which are being deleted
+    m_iContinuationDepth.storeRelease(0);
     clear();
     QMutexLocker locker(&m_mutex);
+    // deleting a thread waits for its job to return, including the expired jobs
     m_vThreads.clear();
+    m_vspAbandoned.clear();
 }
 
 //-----------------------------------------------------------------------------
 
 void JobManager::appendJob(AbstractJob* pJob)
 {
+    if ((m_iOverflowPolicy.loadAcquire() != opQueue) && (throttle(pJob) == true)) {
+        return;
+    }
+
+    if (QThread::currentThread() != thread()) {
+        // the job will be started and released from the JobManager's thread
+        pJob->moveToThread(thread());
+        pJob->m_pThread = thread();
+        // only the first job of a batch needs to wake up the JobManager's thread
+        if (m_quSubmitted.push(pJob) == true) {
+            QMetaObject::invokeMethod(this, "collectSubmitted", Qt::QueuedConnection);
+        }
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    appendJobUnsafe(JobPointer(pJob));
+}
+
+//-----------------------------------------------------------------------------
+
+bool JobManager::throttle(AbstractJob* pJob)
+{
+    // the mutex is only locked, when the queue is full, so the appending threads
+    // do not contend for it otherwise
+    int iMaxWaiting = m_iMaxWaiting.loadAcquire();
+    if ((iMaxWaiting <= 0) || (waitingCount() < iMaxWaiting)) {
+        return false;
+    }
+
+    int iPolicy = m_iOverflowPolicy.loadAcquire();
+    if (iPolicy == opQueue) {
+        return false;
+    }
+    if (iPolicy == opBlock) {
+        // the JobManager's thread and the threads processing the jobs have to keep
+        // draining the queue, so only the other threads are blocked
+        if ((QThread::currentThread() == thread()) || (dynamic_cast<Thread*>(QThread::currentThread()) != nullptr)) {
+            return false;
+        }
+        QMutexLocker locker(&m_mutex);
+        while (
+               (m_eStatus == sRunning) && (isStopped() == false) &&
+               (m_iOverflowPolicy.loadAcquire() == opBlock) &&
+               (m_iMaxWaiting.loadAcquire() > 0) &&
+               (waitingCount() >= m_iMaxWaiting.loadAcquire())
+               ) {
+            // the timeout is a safety net, the condition is signalled when a job starts
+            m_condSpace.wait(&m_mutex, 50);
+        }
+        return false;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    // the policy may have been changed meanwhile
+    iMaxWaiting = m_iMaxWaiting.loadAcquire();
+    if (
+            (m_eStatus != sRunning) || (isStopped() == true) || (m_eError != jmeNoError) ||
+            (m_gate.isClosed() == true) ||
+            (m_iOverflowPolicy.loadAcquire() != opCallerRuns) ||
+            (iMaxWaiting <= 0) || (waitingCount() < iMaxWaiting) ||
+            (pJob->canStart() == false)
+            ) {
+        return false;
+    }
+
+    // the job is processed by the calling thread and counted as a running job
+    ++m_iRunning;
+    ++m_iInline;
+    ++pJob->m_iAttempts;
+    pJob->m_token.setParent(&m_token);
+    pJob->m_pGate = &m_gate;
+    pJob->m_pCache = m_pCache;
+    locker.unlock();
+
+    QElapsedTimer timer;
+    timer.start();
+    pJob->exec();
+    pJob->m_iRunTime = timer.elapsed();
+    pJob->m_token.setParent(nullptr);
+
+    if (QThread::currentThread() != thread()) {
+        pJob->moveToThread(thread());
+        pJob->m_pThread = thread();
+    }
+    if (m_quInline.push(pJob) == true) {
+        QMetaObject::invokeMethod(this, "collectInline", Qt::QueuedConnection);
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::appendJobs(const QVector<AbstractJob*>& vpJobs)
+{
+    if (QThread::currentThread() != thread()) {
+        for (int i = 0; i < vpJobs.count(); ++i) {
+            vpJobs[i]->moveToThread(thread());
+            vpJobs[i]->m_pThread = thread();
+        }
+        if (m_quSubmitted.push(vpJobs) == true) {
+            QMetaObject::invokeMethod(this, "collectSubmitted", Qt::QueuedConnection);
+        }
+        return;
+    }
+
     QMutexLocker locker(&m_mutex);
-    QSharedPointer<AbstractJob> spJob(pJob);
-    appendJobUnsafe(spJob);
+    m_vspJobs.reserve(m_vspJobs.count() + vpJobs.count());
+    m_quWaiting.reserve(m_quWaiting.count() + vpJobs.count());
+    for (int i = 0; i < vpJobs.count(); ++i) {
+        appendJobUnsafe(JobPointer(vpJobs[i]));
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -52,16 +198,121 @@ void JobManager::appendJob(AbstractJob* pJob)
 void JobManager::clear()
 {
     QMutexLocker locker(&m_mutex);
+    collectSubmittedUnsafe();
     m_vspJobs.clear();
     m_quWaiting.clear();
+    m_iWaitingDepth.storeRelease(0);
+    m_vRank.clear();
+    m_vCost.clear();
+    m_vvDependents.clear();
+    m_hashIndex.clear();
+    m_iContinued = 0;
+    m_vChain.clear();
+    m_dTotalCost = 0.0;
+    m_dFinishedCost = 0.0;
+    m_bCostHints = false;
+    m_setRelease.clear();
     m_iStarted = 0;
     m_iRunning = 0;
-    m_bStop = false;
+    m_iReleased.storeRelease(0);
+    m_iDropped = 0;
+    m_vTimedOut.clear();
+    m_wheelRetry.clear();
+    m_iRetrying = 0;
+    m_iRetries = 0;
+    m_hashDuplicate.clear();
+    m_hashSpeculated.clear();
+    m_hashWinner.clear();
+    qDeleteAll(m_hashSpawned);
+    m_hashSpawned.clear();
+    m_iSpeculated = 0;
+    m_iSpeculationWins = 0;
+    m_exception = nullptr;
+    m_token.reset();
+    m_timerStop.invalidate();
+    m_iStopLatency = -1;
     m_eError = jmeNoError;
 }
 
 //-----------------------------------------------------------------------------
 
+void JobManager::markFinished(int iInd)
+{
+    if (m_eStatus == sRunning) {
+        return;
+    }
+    QMutexLocker locker(&m_mutex);
+    collectSubmittedUnsafe();
+    if ((iInd >= 0) && (iInd < m_vspJobs.count())) {
+        m_vspJobs[iInd]->m_bFinished = true;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+int JobManager::invalidate(int iInd)
+{
+    if (m_eStatus == sRunning) {
+        return 0;
+    }
+    QMutexLocker locker(&m_mutex);
+    collectSubmittedUnsafe();
+    if ((iInd < 0) || (iInd >= m_vspJobs.count())) {
+        return 0;
+    }
+    // the dependencies may have been added after the previous run
+    m_vvDependents.clear();
+    m_hashIndex.clear();
+    updateDependentsUnsafe();
+
+    int iCnt = 0;
+    QVector<bool> vDirty(m_vspJobs.count(), false);
+    QVector<int> vStack;
+    vStack.append(iInd);
+    vDirty[iInd] = true;
+    while (vStack.isEmpty() == false) {
+        int iJob = vStack.takeLast();
+        if (m_vspJobs[iJob]->m_bFinished == true) {
+            m_vspJobs[iJob]->m_bFinished = false;
+            ++iCnt;
+        }
+        // a value freed after the previous run has to be produced again
+        const QVector<AbstractInputPort*>& rvpPorts = m_vspJobs[iJob]->m_vpInputPorts;
+        for (int i = 0; i < rvpPorts.count(); ++i) {
+            int iProducer = m_hashIndex.value(rvpPorts[i]->producer(), -1);
+            if (
+                    (iProducer >= 0) && (vDirty[iProducer] == false) &&
+                    (rvpPorts[i]->hasValue() == false)
+                    ) {
+                vDirty[iProducer] = true;
+                vStack.append(iProducer);
+            }
+        }
+        const QVector<int>& rvDependents = m_vvDependents[iJob];
+        for (int i = 0; i < rvDependents.count(); ++i) {
+            if (vDirty[rvDependents[i]] == false) {
+                vDirty[rvDependents[i]] = true;
+                vStack.append(rvDependents[i]);
+            }
+        }
+    }
+    return iCnt;
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::setOrderedRelease(bool bOrdered, int iWindow)
+{
+    if (m_eStatus == sRunning) {
+        // cannot change the release mode while processing!
+        return;
+    }
+    m_bOrderedRelease = bOrdered;
+    m_iReleaseWindow = iWindow;
+}
+
+//-----------------------------------------------------------------------------
+
 void JobManager::setAllowedErrors(int iN)
 {
     m_iAllowedErrors = iN;
@@ -69,6 +320,146 @@ void JobManager::setAllowedErrors(int iN)
 
 //-----------------------------------------------------------------------------
 
+void JobManager::setErrorPolicy(JobErrorPolicy ePolicy)
+{
+    m_eErrorPolicy = ePolicy;
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::setJobTimeout(int iMS)
+{
+    m_iJobTimeout = iMS;
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::setSpeculation(bool bSpeculation, double dFactor, int iMinSamples)
+{
+    QMutexLocker locker(&m_mutex);
+    m_bSpeculation = bSpeculation;
+    m_dSpeculationFactor = dFactor;
+    m_iSpeculationSamples = iMinSamples;
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::setSchedulingPolicy(AbstractSchedulingPolicy* pPolicy)
+{
+    if (pPolicy == nullptr) {
+        pPolicy = new FifoPolicy;
+    }
+    QMutexLocker locker(&m_mutex);
+    m_spPolicy = QSharedPointer<AbstractSchedulingPolicy>(pPolicy);
+    m_spPolicy->reset();
+}
+
+//-----------------------------------------------------------------------------
+
+AbstractSchedulingPolicy* JobManager::schedulingPolicy() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_spPolicy.data();
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::setCriticalPathScheduling(bool bCriticalPath)
+{
+    if (bCriticalPath == true) {
+        setSchedulingPolicy(new CriticalPathPolicy);
+    }   else {
+        setSchedulingPolicy(new FifoPolicy);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+bool JobManager::isCriticalPathScheduling() const
+{
+    return dynamic_cast<CriticalPathPolicy*>(schedulingPolicy()) != nullptr;
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::setLongestFirstScheduling(bool bLongestFirst)
+{
+    if (bLongestFirst == true) {
+        setSchedulingPolicy(new LongestFirstPolicy);
+    }   else {
+        setSchedulingPolicy(new FifoPolicy);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+bool JobManager::isLongestFirstScheduling() const
+{
+    return dynamic_cast<LongestFirstPolicy*>(schedulingPolicy()) != nullptr;
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::setContinuationDepth(int iDepth)
+{
+    QMutexLocker locker(&m_mutex);
+    m_iContinuationDepth.storeRelease(qMax(0, iDepth));
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::setOverflowPolicy(OverflowPolicy ePolicy, int iMaxWaiting)
+{
+    QMutexLocker locker(&m_mutex);
+    m_iOverflowPolicy.storeRelease(ePolicy);
+    m_iMaxWaiting.storeRelease(iMaxWaiting);
+    m_condSpace.wakeAll();
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::setIdleProfile(IdleProfile eProfile)
+{
+    QMutexLocker locker(&m_mutex);
+    m_eIdleProfile = eProfile;
+    for (int i = 0; i < m_vThreads.count(); ++i) {
+        m_vThreads[i]->setIdleProfile(eProfile);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+qint64 JobManager::estimatedRemainingTime() const
+{
+    QMutexLocker locker(&m_mutex);
+    if ((m_timerRun.isValid() == false) || (m_dFinishedCost <= 0)) {
+        return -1;
+    }
+    if (isRunning() == false) {
+        return 0;
+    }
+    double dRate = m_timerRun.elapsed()/m_dFinishedCost;
+    return static_cast<qint64>(dRate*qMax(0.0, m_dTotalCost - m_dFinishedCost));
+}
+
+//-----------------------------------------------------------------------------
+
+double JobManager::rank(int iInd) const
+{
+    QMutexLocker locker(&m_mutex);
+    return (iInd < m_vRank.count())? m_vRank[iInd] : 0.0;
+}
+
+//-----------------------------------------------------------------------------
+
+QVector<int> JobManager::timedOutJobs() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_vTimedOut;
+}
+
+//-----------------------------------------------------------------------------
+
 void JobManager::setProgressReportTimeout(int iMS)
 {
     m_timer.setInterval(iMS);
@@ -91,7 +482,7 @@ void JobManager::addThreads(int iT)
 {
     QMutexLocker locker(&m_mutex);
     for (int i = 0; i < iT; ++i) {
-        auto spThr = QSharedPointer<Thread>(new Thread);
+        auto spThr = createThread(m_vThreads.count());
         m_vThreads.append(spThr);
         m_quIdle.enqueue(spThr);
         if (isRunning() == true) {
@@ -107,7 +498,7 @@ int JobManager::threadsRunningCount() const
     QMutexLocker locker(&m_mutex);
     int iCnt = 0;
     for (int i = 0; i < m_vThreads.count(); ++i) {
-        if (m_vThreads[i]->isRunning() == true) {
+        if (m_vThreads[i]->isBusy() == true) {
             ++iCnt;
         }
     }
@@ -119,24 +510,88 @@ int JobManager::threadsRunningCount() const
 
 bool JobManager::start()
 {
+    // the lock is held until the first jobs are started, since a thread may finish
+    // its job and continue with the next one in the meantime
+    QMutexLocker locker(&m_mutex);
     if (m_eStatus == sRunning) {
         // cannot start while already processing!
         return false;
     }
+    collectSubmittedUnsafe();
+
     m_eStatus = sRunning;
     m_iErrors = 0;
+    m_iDropped = 0;
+    m_vTimedOut.clear();
+    m_wheelRetry.clear();
+    m_iRetrying = 0;
+    m_iRetries = 0;
+    m_hashDuplicate.clear();
+    m_hashSpeculated.clear();
+    m_hashWinner.clear();
+    qDeleteAll(m_hashSpawned);
+    m_hashSpawned.clear();
+    m_iSpeculated = 0;
+    m_iSpeculationWins = 0;
+    m_exception = nullptr;
     m_iStarted = 0;
-    m_iFinished = 0;
+    m_iFinished.storeRelease(0);
     m_iRunning = 0;
-    m_bStop = false;
+    m_iReleased.storeRelease(0);
+    m_setRelease.clear();
+    m_token.reset();
+    m_timerStop.invalidate();
+    m_iStopLatency = -1;
     m_eError = jmeNoError;
+    // a pause ends with the processing it paused, e.g. when it was stopped meanwhile
+    m_gate.open();
 
     if (m_vspJobs.count() == 0) {
         // nothing to do
         m_eStatus = sFinished;
+        locker.unlock();
+        emit signalFinished();
+        return true;
+    }
+
+    for (int i = 0; i < m_vspJobs.count(); ++i) {
+        m_vspJobs[i]->m_iAttempts = 0;
+        // the dependencies may have been invalidated since the previous run
+        m_vspJobs[i]->m_iFirstUnfinished = 0;
+    }
+    // the costs are estimated again, since more processing times may be known by now
+    computeCostsUnsafe();
+    m_dFinishedCost = 0.0;
+    m_timerRun.start();
+    // the jobs already finished (in the previous run or marked with markFinished())
+    // are counted, but not processed again
+    m_quWaiting.clear();
+    for (int i = 0; i < m_vspJobs.count(); ++i) {
+        if (m_vspJobs[i]->isFinished() == true) {
+            ++m_iStarted;
+            countFinishedUnsafe(i);
+            if (m_bOrderedRelease == true) {
+                releaseOrdered(i);
+            }
+        }   else {
+            m_quWaiting.enqueue(i);
+        }
+    }
+    m_iWaitingDepth.storeRelease(m_quWaiting.count());
+    if (m_iFinished.loadAcquire() == m_vspJobs.count()) {
+        m_eStatus = sFinished;
+        locker.unlock();
         emit signalFinished();
         return true;
     }
+    // the ranks and the dependents are found again, when they are needed, since
+    // dependencies may have been added after the jobs were appended
+    m_vRank.clear();
+    m_vvDependents.clear();
+    m_hashIndex.clear();
+    m_iContinued = 0;
+    m_vChain.clear();
+    m_spPolicy->reset();
 
     int iN = qMin(m_vThreads.count(), m_vspJobs.count());
     for (int i = 0; i < iN; ++i) {
@@ -155,7 +610,17 @@ void JobManager::stop()
 {
     QMutexLocker locker(&m_mutex);
     //m_eStatus = sStopped;
-    m_bStop = true;
+    if (m_timerStop.isValid() == false) {
+        m_timerStop.start();
+    }
+    locker.unlock();
+    // cancelling the token reaches all the running jobs at once; the callbacks of the
+    // job tokens are called without holding the lock, so they can use the JobManager
+    m_token.cancel();
+
+    locker.relock();
+    m_condSpace.wakeAll();
+    m_gate.wakeAll();
 
     for (int i = 0; i < m_vThreads.count(); ++i) {
         //m_vThreads[i]->disconnect();
@@ -166,16 +631,73 @@ void JobManager::stop()
             m_vspJobs[m_vThreads[i]->jobIndex()]->stop();
         }
     }
+    if ((m_eStatus == sRunning) && (m_iRunning == 0)) {
+        // no job is running, e.g. only retries are waiting for their delay, so no
+        // finishing job would report the stop
+        m_wheelRetry.clear();
+        m_iRetrying = 0;
+        checkNext();
+    }
     //emit signalFinished();
 }
 
 //-----------------------------------------------------------------------------
 
+void JobManager::pause()
+{
+    QMutexLocker locker(&m_mutex);
+    m_gate.close();
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::resume()
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_gate.isClosed() == false) {
+        return;
+    }
+    m_gate.open();
+
+    if ((m_eStatus == sRunning) && (isStopped() == false)) {
+        int iN = qMax(1, qMin(m_quWaiting.count(), m_quIdle.count()));
+        for (int i = 0; i < iN; ++i)
+            checkNext();
+        if (m_eStatus == sFinished) {
+            locker.unlock();
+            emit signalFinished();
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+bool JobManager::wait(int iMS)
+{
+    if (isRunning() == true) {
+        QEventLoop loop;
+        connect(this, SIGNAL(signalFinished()), &loop, SLOT(quit()));
+        connect(this, SIGNAL(signalStopped()), &loop, SLOT(quit()));
+        connect(this, SIGNAL(signalError(thr::JobManagerError)), &loop, SLOT(quit()));
+        if (iMS >= 0) {
+            QTimer::singleShot(iMS, &loop, SLOT(quit()));
+        }
+        loop.exec();
+    }
+
+    if (m_exception != nullptr) {
+        std::rethrow_exception(m_exception);
+    }
+    return isRunning() == false;
+}
+
+//-----------------------------------------------------------------------------
+
 void JobManager::handleJobFinished()
 {
     QMutexLocker locker(&m_mutex);
 
-    ++m_iFinished;
+    collectSubmittedUnsafe();
     Thread* pThr = dynamic_cast<Thread*>(sender());
     QSharedPointer<Thread> spThr;
     for (int i = 0; i < m_vThreads.count(); ++i) {
@@ -183,36 +705,42 @@ void JobManager::handleJobFinished()
             spThr = m_vThreads[i];
         }
     }
-    assert(spThr.data() != 0);
-    int iInd = spThr->jobIndex();
-
-    int iCnt = 0;
-    AbstractJob* pJob = m_vspJobs[iInd]->nextSpawnedJob();
-    while (pJob != nullptr) {
-        ++iCnt;
-        pJob->setSpawned();
-        QSharedPointer<AbstractJob> spJob(pJob);
-        appendJobUnsafe(spJob);
-        pJob = m_vspJobs[iInd]->nextSpawnedJob();
+    if (spThr.isNull() == true) {
+        // the thread was abandoned by the watchdog, its job has already been counted
+        return;
     }
+    if (m_hashDuplicate.contains(pThr) == true) {
+        handleDuplicateFinishedUnsafe(spThr);
+        if (m_eStatus == sFinished) {
+            locker.unlock();
+            emit signalFinished();
+        }
+        return;
+    }
+    int iInd = spThr->jobIndex();
 
-    m_vspJobs[iInd]->cleanup();
-
+    m_vspJobs[iInd]->m_token.setParent(nullptr);
     m_quIdle.enqueue(spThr);
     --m_iRunning;
 
-    if (m_vspJobs[iInd]->isError() == true) {
-        ++m_iErrors;
+    if (m_hashSpeculated.contains(iInd) == true) {
+        // the original finished first, the duplicate is not needed anymore
+        m_hashDuplicate[m_hashSpeculated.take(iInd)]->stop();
     }
-
-    if (m_bReportJobFinish == true) {
-        emit signalJobFinished(m_vspJobs[iInd]);
+    JobPointer spWinner = m_hashWinner.take(iInd);
+    if (spWinner.isNull() == false) {
+        // the duplicate finished first and this job was stopped because of that
+        m_vspJobs[iInd]->m_token.reset();
+        m_vspJobs[iInd]->m_iError.storeRelease(0);
+        m_vspJobs[iInd]->adoptResult(spWinner.data());
+    }   else {
+        m_vspJobs[iInd]->m_iRunTime = spThr->elapsed();
+        if (m_vspJobs[iInd]->isError() == false) {
+            recordRunTimeUnsafe(m_vspJobs[iInd].data());
+        }
     }
 
-    int iN = qMax(1, qMin(m_quWaiting.count(), m_quIdle.count()));
-    for (int i = 0; i < iN; ++i)
-        checkNext();
-
+    completeJobUnsafe(iInd, spThr);
     if (m_eStatus == sFinished) {
         locker.unlock();
         emit signalFinished();
@@ -221,42 +749,189 @@ void JobManager::handleJobFinished()
 
 //-----------------------------------------------------------------------------
 
-void JobManager::reportProgress()
+void JobManager::completeJobUnsafe(int iInd, const QSharedPointer<Thread>& spThr)
 {
-    if (m_vspJobs.count() > 0) {
-        emit signalProgress(100*m_iFinished/m_vspJobs.count());
+    if (scheduleRetryUnsafe(iInd) == true) {
+        // the jobs spawned by a failed attempt are dropped, the next attempt spawns its own
+        AbstractJob* pJob = takeSpawnedJobUnsafe(iInd);
+        while (pJob != nullptr) {
+            delete pJob;
+            pJob = takeSpawnedJobUnsafe(iInd);
+        }
+        // the job is not finished yet, give its thread to another job meanwhile
+        int iN = qMax(1, qMin(m_quWaiting.count(), m_quIdle.count()));
+        for (int i = 0; i < iN; ++i)
+            checkNext();
+        return;
+    }
+
+    finishJobUnsafe(iInd);
+
+    if ((m_iContinuationDepth.loadAcquire() > 0) && (spThr.isNull() == false)) {
+        startContinuationUnsafe(iInd, spThr);
     }
+
+    int iN = qMax(1, qMin(m_quWaiting.count(), m_quIdle.count()));
+    for (int i = 0; i < iN; ++i)
+        checkNext();
 }
 
 //-----------------------------------------------------------------------------
 
-void JobManager::checkNext()
+void JobManager::finishJobUnsafe(int iInd)
 {
-    if ((m_iAllowedErrors >= 0) && (m_iErrors > m_iAllowedErrors)) {
-        m_eError = jmeTooManyErrors;
+    AbstractJob* pJob = takeSpawnedJobUnsafe(iInd);
+    while (pJob != nullptr) {
+        pJob->setSpawned();
+        appendJobUnsafe(JobPointer(pJob));
+        pJob = takeSpawnedJobUnsafe(iInd);
     }
 
-    if (handleError() == true) {
+    countFinishedUnsafe(iInd);
+    m_vspJobs[iInd]->cleanup();
+
+    if (m_vspJobs[iInd]->isError() == true) {
+        ++m_iErrors;
+        if (m_exception == nullptr) {
+            m_exception = m_vspJobs[iInd]->exception();
+        }
+    }
+
+    if (m_bReportJobFinish == true) {
+        emit signalJobFinished(m_vspJobs[iInd]);
+    }
+
+    if (m_bOrderedRelease == true) {
+        releaseOrdered(iInd);
+    }
+
+    if ((m_vspJobs[iInd]->isError() == true) && (m_eErrorPolicy != jepWait)) {
+        dropDependentsUnsafe(iInd);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+AbstractJob* JobManager::takeSpawnedJobUnsafe(int iInd)
+{
+    if (m_hashSpawned.contains(iInd) == true) {
+        return m_hashSpawned.take(iInd);
+    }
+    return m_vspJobs[iInd]->nextSpawnedJob();
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::reportProgress()
+{
+    QMutexLocker locker(&m_mutex);
+    int iPer = -1;
+    if ((m_bCostHints == true) && (m_vCost.count() == m_vspJobs.count()) && (m_dTotalCost > 0)) {
+        // weighted by the estimated processing time, so a few long jobs do not
+        // distort the progress
+        iPer = static_cast<int>(100*m_dFinishedCost/m_dTotalCost);
+    }   else if (m_vspJobs.count() > 0) {
+        iPer = 100*m_iFinished.loadAcquire()/m_vspJobs.count();
+    }
+    locker.unlock();
+
+    if (iPer >= 0) {
+        emit signalProgress(iPer);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::collectSubmitted()
+{
+    QMutexLocker locker(&m_mutex);
+    if (collectSubmittedUnsafe() == 0) {
+        return;
+    }
+    startWaitingUnsafe();
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::startWaiting()
+{
+    QMutexLocker locker(&m_mutex);
+    startWaitingUnsafe();
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::startWaitingUnsafe()
+{
+    if ((m_eStatus == sRunning) && (isStopped() == false) && (m_eError == jmeNoError)) {
+        int iN = qMin(m_quWaiting.count(), m_quIdle.count());
+        for (int i = 0; i < iN; ++i) {
+            startNext();
+        }
+        handleError();
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::collectInline()
+{
+    QMutexLocker locker(&m_mutex);
+    collectSubmittedUnsafe();
+    QVector<AbstractJob*> vpJobs;
+    m_quInline.takeAll(vpJobs);
+    for (int i = 0; i < vpJobs.count(); ++i) {
+        // the job is already processed, so it is not queued
+        int iInd = m_vspJobs.count();
+        appendJobUnsafe(JobPointer(vpJobs[i]));
+        m_quWaiting.removeLast();
+        m_iWaitingDepth.storeRelease(m_quWaiting.count());
+        ++m_iStarted;
+        --m_iRunning;
+        --m_iInline;
+        if (vpJobs[i]->isError() == false) {
+            recordRunTimeUnsafe(vpJobs[i]);
+        }
+        completeJobUnsafe(iInd, QSharedPointer<Thread>());
+    }
+
+    if (m_eStatus == sFinished) {
+        locker.unlock();
+        emit signalFinished();
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::checkNext()
+{
+    if ((m_iAllowedErrors >= 0) && (m_iErrors > m_iAllowedErrors)) {
+        m_eError = jmeTooManyErrors;
+    }
+
+    if (handleError() == true) {
         // prevent new jobs being started if an error occured
         return;
     }
 
-    if (m_bStop == true) {
+    if (isStopped() == true) {
         if (m_iRunning == 0) {
             m_eStatus = sStopped;
+            m_iStopLatency = m_timerStop.isValid()? static_cast<int>(m_timerStop.elapsed()) : 0;
             emit signalStopped();
         }
         // prevent new jobs being started if processing was stopped by the caller
         return;
     }
 
-    if (m_iFinished < m_vspJobs.count()) {
+    if ((m_iFinished.loadAcquire() < m_vspJobs.count()) || (m_iInline > 0)) {
         startNext();
         if (handleError() == true) {
             // prevent new jobs being started if an error occured
             return;
         }
-    }   else {
+    }   else if (m_iRunning == 0) {
+        // a losing duplicate may still be running, the processing is finished after it stops
         if (m_timer.interval() > 0) {
             emit signalProgress(100);
             m_timer.stop();
@@ -270,36 +945,694 @@ void JobManager::checkNext()
 
 void JobManager::startNext()
 {
-    auto spThr = m_quIdle.dequeue();
-    spThr->disconnect();
-    if (m_iStarted < m_vspJobs.count()) {
-        for (int i = 0; i < m_quWaiting.count(); ++i) {
-            if (m_vspJobs[m_quWaiting.front()]->canStart() == true) {
-                int iCurrent = m_quWaiting.dequeue();
-                //m_vJobs[iCurrent]->moveToThread(pThr);
-                //connect(pThr, SIGNAL(started()), m_vJobs[iCurrent], SLOT(start()));
-                //connect(m_vJobs[iCurrent], SIGNAL(signalFinished()), pThr, SLOT(quit()));
-                //connect(m_vJobs[iCurrent], SIGNAL(signalStopped()), pThr, SLOT(quit()));
-                //connect(m_vJobs[iCurrent], SIGNAL(signalError()), pThr, SLOT(quit()));
-                //connect(pThr, SIGNAL(finished()), this, SLOT(handleJobFinished()));
-                connect(spThr.data(), &QThread::finished, this, &JobManager::handleJobFinished);
-                //m_vIndex[iInd] = iCurrent;
-                //pThr->start();
-                spThr->start(iCurrent, m_vspJobs[iCurrent]);
-                ++m_iStarted;
-                ++m_iRunning;
-                return;
-            }   else {
-                m_quWaiting.enqueue(m_quWaiting.dequeue());
-            }
-        }
+    if (
+            (m_gate.isClosed() == true) || (m_quIdle.isEmpty() == true) ||
+            (m_iStarted >= m_vspJobs.count())
+            ) {
+        return;
+    }
+    int iCurrent = takeNextJobUnsafe();
+    if (iCurrent < 0) {
         // should not get here!
-        if (m_iRunning == 0) {
+        if ((m_iRunning == 0) && (m_iRetrying == 0)) {
             qWarning() << "JobManager: could not find job to start, unfinished jobs left: " << m_quWaiting.count();
             m_eError = jmeNoJobReady;
         }
+        return;
+    }
+
+    auto spThr = takeIdleThreadUnsafe(m_vspJobs[iCurrent].data());
+    if (spThr->index() < m_vChain.count()) {
+        // the thread leaves its chain of continuations
+        m_vChain[spThr->index()] = 0;
+    }
+    startJobUnsafe(iCurrent, spThr);
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::startJobUnsafe(int iInd, const QSharedPointer<Thread>& spThr)
+{
+    if (m_iOverflowPolicy.loadAcquire() == opBlock) {
+        m_condSpace.wakeAll();
+    }
+    spThr->disconnect();
+    connect(spThr.data(), &Thread::signalJobDone, this, &JobManager::handleJobFinished);
+    m_vspJobs[iInd]->m_token.setParent(&m_token);
+    m_vspJobs[iInd]->m_pGate = &m_gate;
+    m_vspJobs[iInd]->m_pCache = m_pCache;
+    ++m_vspJobs[iInd]->m_iAttempts;
+    m_vspJobs[iInd]->m_iWorker = spThr->index();
+    spThr->start(iInd, m_vspJobs[iInd]);
+    ++m_iStarted;
+    ++m_iRunning;
+    int iTimeout = effectiveTimeout(iInd);
+    if (iTimeout > 0) {
+        // check the deadline several times per timeout period
+        armWatchdogUnsafe(qBound(1, iTimeout/8, 100));
+    }
+    if ((m_bSpeculation == true) && (m_vspJobs[iInd]->isIdempotent() == true)) {
+        armWatchdogUnsafe(SPECULATION_INTERVAL);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+bool JobManager::startContinuationUnsafe(int iInd, const QSharedPointer<Thread>& spThr)
+{
+    int iNext = findContinuationUnsafe(iInd, spThr->index());
+    if (iNext < 0) {
+        return false;
+    }
+    m_quWaiting.removeOne(iNext);
+    m_iWaitingDepth.storeRelease(m_quWaiting.count());
+    m_quIdle.removeOne(spThr);
+    ++m_vChain[spThr->index()];
+    ++m_iContinued;
+    startJobUnsafe(iNext, spThr);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+int JobManager::findContinuationUnsafe(int iInd, int iSlot)
+{
+    if (
+            (m_eStatus != sRunning) || (isStopped() == true) || (m_eError != jmeNoError) ||
+            (m_gate.isClosed() == true) || (m_vspJobs[iInd]->isError() == true)
+            ) {
+        return -1;
+    }
+    if (iSlot >= m_vChain.count()) {
+        m_vChain.resize(m_vThreads.count());
+    }
+    if (m_vChain[iSlot] >= m_iContinuationDepth.loadAcquire()) {
+        return -1;
+    }
+
+    updateDependentsUnsafe();
+    const AbstractJob* pJob = m_vspJobs[iInd].data();
+    const QVector<int>& rvDependents = m_vvDependents[iInd];
+    for (int i = 0; i < rvDependents.count(); ++i) {
+        int iNext = rvDependents[i];
+        if (isInReleaseWindow(iNext) == false) {
+            continue;
+        }
+        // the finished job itself may not be marked as finished yet
+        const AbstractJob* pNext = m_vspJobs[iNext].data();
+        bool bReady = true;
+        for (int j = pNext->m_iFirstUnfinished; (j < pNext->m_vspDependency.count()) && (bReady == true); ++j) {
+            const AbstractJob* pDep = pNext->m_vspDependency[j].data();
+            bReady = (pDep == pJob) || (pDep->isFinished() == true);
+        }
+        // a dependent of the finished job is either waiting, already started or dropped
+        if ((bReady == true) && (m_quWaiting.contains(iNext) == true)) {
+            return iNext;
+        }
+    }
+    return -1;
+}
+
+//-----------------------------------------------------------------------------
+
+bool JobManager::continueInThread(Thread* pThr)
+{
+    // the JobManager may be busy or being deleted; the job is then finished the usual way
+    if ((m_iContinuationDepth.loadAcquire() <= 0) || (m_mutex.tryLock() == false)) {
+        return false;
+    }
+    bool bContinued = continueInThreadUnsafe(pThr);
+    m_mutex.unlock();
+    return bContinued;
+}
+
+//-----------------------------------------------------------------------------
+
+bool JobManager::continueInThreadUnsafe(Thread* pThr)
+{
+    QSharedPointer<Thread> spThr;
+    for (int i = 0; i < m_vThreads.count(); ++i) {
+        if (m_vThreads[i].data() == pThr) {
+            spThr = m_vThreads[i];
+        }
+    }
+    if (spThr.isNull() == true) {
+        // the thread was abandoned by the watchdog
+        return false;
+    }
+    int iInd = spThr->jobIndex();
+    if (
+            (m_eStatus != sRunning) || (iInd < 0) || (iInd >= m_vspJobs.count()) ||
+            (m_bReportJobFinish == true) || (m_bOrderedRelease == true)
+            ) {
+        // the jobs were cleared meanwhile or the finished job has to be reported by
+        // signals, which are emitted in the JobManager's thread
+        return false;
+    }
+    const JobPointer& spJob = m_vspJobs[iInd];
+    if (
+            (m_hashDuplicate.contains(pThr) == true) || (m_hashSpeculated.contains(iInd) == true) ||
+            (m_hashWinner.contains(iInd) == true) || (spJob->isError() == true) ||
+            (spJob->isStopped() == true)
+            ) {
+        return false;
+    }
+    int iNext = findContinuationUnsafe(iInd, spThr->index());
+    if (
+            (iNext < 0) || (effectiveTimeout(iNext) > 0) ||
+            ((m_bSpeculation == true) && (m_vspJobs[iNext]->isIdempotent() == true))
+            ) {
+        // the watchdog can only be armed from the JobManager's thread
+        return false;
+    }
+    AbstractJob* pSpawned = spJob->nextSpawnedJob();
+    if (pSpawned != nullptr) {
+        // the jobs are only appended in the JobManager's thread, so the vector of jobs
+        // is never reallocated while it is read from there without locking mutex
+        pSpawned->moveToThread(thread());
+        pSpawned->m_pThread = thread();
+        m_hashSpawned.insert(iInd, pSpawned);
+        return false;
+    }
+
+    // the job succeeded, so it is neither retried nor counted as an error
+    spJob->m_token.setParent(nullptr);
+    --m_iRunning;
+    spJob->m_iRunTime = spThr->elapsed();
+    recordRunTimeUnsafe(spJob.data());
+    finishJobUnsafe(iInd);
+
+    m_quWaiting.removeOne(iNext);
+    m_iWaitingDepth.storeRelease(m_quWaiting.count());
+    ++m_vChain[spThr->index()];
+    ++m_iContinued;
+    startJobUnsafe(iNext, spThr);
+    if ((m_quIdle.isEmpty() == false) && (m_quWaiting.isEmpty() == false)) {
+        // the finished job may have made other jobs ready for the idle threads
+        QMetaObject::invokeMethod(this, "startWaiting", Qt::QueuedConnection);
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::updateDependentsUnsafe()
+{
+    int iFirst = m_vvDependents.count();
+    int iN = m_vspJobs.count();
+    m_vvDependents.resize(iN);
+    for (int i = iFirst; i < iN; ++i) {
+        m_hashIndex.insert(m_vspJobs[i].data(), i);
+    }
+    for (int i = iFirst; i < iN; ++i) {
+        const QVector<JobPointer>& rvspDep = m_vspJobs[i]->m_vspDependency;
+        for (int j = 0; j < rvspDep.count(); ++j) {
+            int iDep = m_hashIndex.value(rvspDep[j].data(), -1);
+            if (iDep >= 0) {
+                m_vvDependents[iDep].append(i);
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+int JobManager::takeNextJobUnsafe()
+{
+    // the view is read-only, so the costs and ranks of the added jobs are computed here
+    if ((m_spPolicy->needsRanks() == true) && (m_vRank.count() != m_vspJobs.count())) {
+        computeRanksUnsafe();
+    }
+    if ((m_spPolicy->needsCosts() == true) && (m_vCost.count() != m_vspJobs.count())) {
+        computeCostsUnsafe();
+    }
+    SchedulingQueue queue(this);
+    int iPos = m_spPolicy->selectJob(queue);
+    if ((iPos < 0) || (iPos >= m_quWaiting.count())) {
+        return -1;
+    }
+    int iNext = m_quWaiting.takeAt(iPos);
+    m_iWaitingDepth.storeRelease(m_quWaiting.count());
+    return iNext;
+}
+
+//-----------------------------------------------------------------------------
+
+QSharedPointer<Thread> JobManager::takeIdleThreadUnsafe(const AbstractJob* pJob)
+{
+    QVector<int> vIdle = SchedulingQueue(this).idleThreads();
+    int iPos = m_spPolicy->selectThread(pJob, vIdle);
+    if ((iPos < 0) || (iPos >= m_quIdle.count())) {
+        iPos = 0;
+    }
+    return m_quIdle.takeAt(iPos);
+}
+
+//-----------------------------------------------------------------------------
+
+double JobManager::estimatedCostUnsafe(const AbstractJob* pJob) const
+{
+    if (pJob->cost() > 0) {
+        return pJob->cost();
+    }
+    qint64 iMedian = medianRunTimeUnsafe(pJob, 1);
+    return (iMedian > 0)? static_cast<double>(iMedian) : 1.0;
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::computeCostsUnsafe()
+{
+    m_vCost.resize(m_vspJobs.count());
+    m_dTotalCost = 0.0;
+    m_bCostHints = false;
+    for (int i = 0; i < m_vspJobs.count(); ++i) {
+        m_vCost[i] = estimatedCostUnsafe(m_vspJobs[i].data());
+        m_dTotalCost += m_vCost[i];
+        if (m_vspJobs[i]->cost() > 0) {
+            m_bCostHints = true;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::countFinishedUnsafe(int iInd)
+{
+    m_iFinished.fetchAndAddRelease(1);
+    if (iInd < m_vCost.count()) {
+        m_dFinishedCost += m_vCost[iInd];
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::computeRanksUnsafe()
+{
+    int iN = m_vspJobs.count();
+    QHash<const AbstractJob*, int> hashIndex;
+    hashIndex.reserve(iN);
+    for (int i = 0; i < iN; ++i) {
+        hashIndex.insert(m_vspJobs[i].data(), i);
+    }
+
+    // vvPred holds the dependencies of every job, vSucc the number of its dependents
+    QVector<QVector<int> > vvPred(iN);
+    QVector<int> vSucc(iN, 0);
+    for (int i = 0; i < iN; ++i) {
+        const QVector<JobPointer>& rvspDep = m_vspJobs[i]->m_vspDependency;
+        for (int j = 0; j < rvspDep.count(); ++j) {
+            int iDep = hashIndex.value(rvspDep[j].data(), -1);
+            if (iDep >= 0) {
+                vvPred[i].append(iDep);
+                ++vSucc[iDep];
+            }
+        }
+    }
+
+    // rank the jobs from the sinks of the graph towards its sources
+    QVector<double> vMaxSucc(iN, 0.0);
+    QVector<int> vReady;
+    for (int i = 0; i < iN; ++i) {
+        if (vSucc[i] == 0) {
+            vReady.append(i);
+        }
+    }
+    if (m_vCost.count() != iN) {
+        computeCostsUnsafe();
+    }
+    m_vRank.fill(0.0, iN);
+    while (vReady.isEmpty() == false) {
+        int i = vReady.last();
+        vReady.removeLast();
+        m_vRank[i] = m_vCost[i] + vMaxSucc[i];
+        for (int j = 0; j < vvPred[i].count(); ++j) {
+            int iDep = vvPred[i][j];
+            vMaxSucc[iDep] = qMax(vMaxSucc[iDep], m_vRank[i]);
+            if (--vSucc[iDep] == 0) {
+                vReady.append(iDep);
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::dropDependentsUnsafe(int iInd)
+{
+    updateDependentsUnsafe();
+    QVector<bool> vWaiting(m_vspJobs.count(), false);
+    for (int i = 0; i < m_quWaiting.count(); ++i) {
+        vWaiting[m_quWaiting[i]] = true;
+    }
+
+    // the dependents are walked breadth first, so every dropped job is visited once;
+    // only the waiting jobs are dropped and passed on to their own dependents
+    QVector<bool> vDropped(m_vspJobs.count(), false);
+    QVector<int> vDrop;
+    vDrop.append(iInd);
+    for (int iHead = 0; iHead < vDrop.count(); ++iHead) {
+        const QVector<int>& rvDependents = m_vvDependents[vDrop[iHead]];
+        for (int i = 0; i < rvDependents.count(); ++i) {
+            int iJob = rvDependents[i];
+            if ((vWaiting[iJob] == true) && (vDropped[iJob] == false)) {
+                vDropped[iJob] = true;
+                vDrop.append(iJob);
+            }
+        }
+    }
+    if (vDrop.count() == 1) {
+        return;
+    }
+
+    // the dropped jobs are removed from the waiting queue in one pass
+    m_quWaiting.erase(
+                std::remove_if(
+                    m_quWaiting.begin(), m_quWaiting.end(),
+                    [&vDropped](int iJob) { return vDropped[iJob]; }
+                    ),
+                m_quWaiting.end()
+                );
+    m_iWaitingDepth.storeRelease(m_quWaiting.count());
+
+    for (int i = 1; i < vDrop.count(); ++i) {
+        int iJob = vDrop[i];
+        AbstractJob* pJob = m_vspJobs[iJob].data();
+        if (m_eErrorPolicy == jepCancelDependents) {
+            pJob->stop();
+            ++m_iErrors;
+        }   else {
+            pJob->m_bSkipped = true;
+        }
+        ++m_iStarted;
+        countFinishedUnsafe(iJob);
+        ++m_iDropped;
+
+        if (m_bReportJobFinish == true) {
+            emit signalJobFinished(m_vspJobs[iJob]);
+        }
+        if (m_bOrderedRelease == true) {
+            releaseOrdered(iJob);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::checkTimeouts()
+{
+    QMutexLocker locker(&m_mutex);
+    for (int i = m_vspAbandoned.count() - 1; i >= 0; --i) {
+        if (m_vspAbandoned[i]->isBusy() == false) {
+            m_vspAbandoned.removeAt(i);
+        }
+    }
+
+    bool bExpired = false;
+    int iFirstExpired = m_vTimedOut.count();
+    // paused jobs are not stopped, since no progress should be lost while paused
+    for (int i = 0; (i < m_vThreads.count()) && (m_gate.isClosed() == false); ++i) {
+        int iInd = m_vThreads[i]->jobIndex();
+        if (
+                (iInd < 0) ||
+                (m_vThreads[i]->isBusy() == false) ||
+                (m_hashDuplicate.contains(m_vThreads[i].data()) == true)
+                ) {
+            continue;
+        }
+        int iTimeout = effectiveTimeout(iInd);
+        if ((iTimeout > 0) && (m_vThreads[i]->elapsed() > iTimeout)) {
+            abandonThreadUnsafe(i);
+            bExpired = true;
+        }
+    }
+
+    if (bExpired == true) {
+        int iN = qMax(1, qMin(m_quWaiting.count(), m_quIdle.count()));
+        for (int i = 0; i < iN; ++i)
+            checkNext();
+    }
+
+    if (
+            (m_bSpeculation == true) && (m_eStatus == sRunning) && (isStopped() == false) &&
+            (m_gate.isClosed() == false)
+            ) {
+        // idle threads are left only when no queued job can be started
+        for (int i = 0; (i < m_vThreads.count()) && (m_quIdle.isEmpty() == false); ++i) {
+            if (isStragglerUnsafe(i) == true) {
+                launchDuplicateUnsafe(i);
+            }
+        }
+    }
+
+    if ((m_eStatus != sRunning) && (m_vspAbandoned.isEmpty() == true)) {
+        m_timerWatchdog.stop();
+    }
+
+    QVector<int> vExpired = m_vTimedOut.mid(iFirstExpired);
+    QVector<JobPointer> vspExpired;
+    for (int i = 0; i < vExpired.count(); ++i) {
+        vspExpired.append(m_vspJobs[vExpired[i]]);
+    }
+    bool bFinished = (bExpired == true) && (m_eStatus == sFinished);
+    locker.unlock();
+
+    // the slots are called without holding the lock, so they can use the JobManager
+    for (int i = 0; i < vExpired.count(); ++i) {
+        emit signalJobTimeout(vExpired[i], vspExpired[i]);
+    }
+    if (bFinished == true) {
+        emit signalFinished();
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::retryJob(int iInd)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_iRetrying == 0) {
+        // the processing was restarted meanwhile
+        return;
+    }
+    --m_iRetrying;
+    if ((m_eStatus != sRunning) || (isStopped() == true) || (m_eError != jmeNoError)) {
+        // the processing has ended meanwhile, the job is not processed anymore
+        if ((m_eStatus == sRunning) && (m_iRunning == 0) && (m_iRetrying == 0)) {
+            // nothing else reports the end of the processing
+            checkNext();
+        }
+        return;
+    }
+
+    --m_iStarted;
+    m_quWaiting.enqueue(iInd);
+    m_iWaitingDepth.storeRelease(m_quWaiting.count());
+    int iN = qMin(m_quWaiting.count(), m_quIdle.count());
+    for (int i = 0; i < iN; ++i) {
+        startNext();
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+bool JobManager::scheduleRetryUnsafe(int iInd)
+{
+    const JobPointer& spJob = m_vspJobs[iInd];
+    if (
+            (spJob->isError() == false) ||
+            (isStopped() == true) ||
+            (m_eError != jmeNoError)
+            ) {
+        return false;
+    }
+
+    RetryPolicy policy = spJob->retryPolicy();
+    if (policy.shouldRetry(spJob->attempts(), spJob->errorCode()) == false) {
+        return false;
+    }
+
+    ++m_iRetrying;
+    ++m_iRetries;
+    m_wheelRetry.schedule(policy.delay(spJob->attempts()), iInd);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::armWatchdogUnsafe(int iInterval)
+{
+    if ((m_timerWatchdog.isActive() == false) || (iInterval < m_timerWatchdog.interval())) {
+        m_timerWatchdog.start(iInterval);
     }
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::recordRunTimeUnsafe(const AbstractJob* pJob)
+{
+    QByteArray baClass(typeid(*pJob).name());
+    m_hashMedian.remove(baClass);
+    QVector<qint64>& rvTimes = m_hashRunTimes[baClass];
+    if (rvTimes.count() >= RUN_TIME_SAMPLES) {
+        // keep the more recent half of the samples
+        rvTimes.remove(0, RUN_TIME_SAMPLES/2);
+    }
+    rvTimes.append(pJob->runTime());
+}
+
+//-----------------------------------------------------------------------------
+
+qint64 JobManager::medianRunTimeUnsafe(const AbstractJob* pJob, int iMinSamples) const
+{
+    QByteArray baClass(typeid(*pJob).name());
+    if (m_hashMedian.contains(baClass) == true) {
+        return (m_hashRunTimes.value(baClass).count() < iMinSamples)? -1 : m_hashMedian.value(baClass);
+    }
+
+    QVector<qint64> vTimes = m_hashRunTimes.value(baClass);
+    if ((vTimes.count() == 0) || (vTimes.count() < iMinSamples)) {
+        return -1;
+    }
+    std::nth_element(vTimes.begin(), vTimes.begin() + vTimes.count()/2, vTimes.end());
+    m_hashMedian.insert(baClass, vTimes[vTimes.count()/2]);
+    return vTimes[vTimes.count()/2];
+}
+
+//-----------------------------------------------------------------------------
+
+bool JobManager::isStragglerUnsafe(int iThr) const
+{
+    const QSharedPointer<Thread>& spThr = m_vThreads[iThr];
+    int iInd = spThr->jobIndex();
+    if (
+            (iInd < 0) ||
+            (spThr->isBusy() == false) ||
+            (m_hashDuplicate.contains(spThr.data()) == true) ||
+            (m_hashSpeculated.contains(iInd) == true) ||
+            (m_hashWinner.contains(iInd) == true) ||
+            (m_vspJobs[iInd]->isIdempotent() == false)
+            ) {
+        return false;
+    }
+
+    qint64 iMedian = medianRunTimeUnsafe(m_vspJobs[iInd].data(), m_iSpeculationSamples);
+    if (iMedian < 0) {
+        return false;
+    }
+    return spThr->elapsed() > qMax(static_cast<qint64>(SPECULATION_INTERVAL),
+                                   static_cast<qint64>(m_dSpeculationFactor*iMedian));
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::launchDuplicateUnsafe(int iThr)
+{
+    int iInd = m_vThreads[iThr]->jobIndex();
+    AbstractJob* pDuplicate = m_vspJobs[iInd]->clone();
+    if (pDuplicate == nullptr) {
+        return;
+    }
+
+    JobPointer spDuplicate(pDuplicate);
+    auto spThr = takeIdleThreadUnsafe(pDuplicate);
+    spThr->disconnect();
+    connect(spThr.data(), &Thread::signalJobDone, this, &JobManager::handleJobFinished);
+    m_hashDuplicate.insert(spThr.data(), spDuplicate);
+    m_hashSpeculated.insert(iInd, spThr.data());
+    spDuplicate->m_token.setParent(&m_token);
+    // the duplicate is paused and looks up the cache like the original
+    spDuplicate->m_pGate = &m_gate;
+    spDuplicate->m_pCache = m_pCache;
+    spThr->start(iInd, spDuplicate);
+    ++m_iRunning;
+    ++m_iSpeculated;
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::handleDuplicateFinishedUnsafe(const QSharedPointer<Thread>& spThr)
+{
+    int iInd = spThr->jobIndex();
+    JobPointer spDuplicate = m_hashDuplicate.take(spThr.data());
+    spDuplicate->m_token.setParent(nullptr);
     m_quIdle.enqueue(spThr);
+    --m_iRunning;
+
+    if (m_hashSpeculated.value(iInd) == spThr.data()) {
+        // the original is still running
+        m_hashSpeculated.remove(iInd);
+        if ((spDuplicate->isError() == false) && (spDuplicate->isStopped() == false)) {
+            // the duplicate won, the original takes over its result, when it stops
+            m_hashWinner.insert(iInd, spDuplicate);
+            m_vspJobs[iInd]->stop();
+            ++m_iSpeculationWins;
+        }
+    }
+
+    if (m_eStatus == sRunning) {
+        int iN = qMax(1, qMin(m_quWaiting.count(), m_quIdle.count()));
+        for (int i = 0; i < iN; ++i)
+            checkNext();
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+int JobManager::effectiveTimeout(int iInd) const
+{
+    int iTimeout = m_vspJobs[iInd]->timeout();
+    if (iTimeout <= 0) {
+        iTimeout = m_iJobTimeout;
+    }
+    return iTimeout;
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::abandonThreadUnsafe(int iThr)
+{
+    QSharedPointer<Thread> spThr = m_vThreads[iThr];
+    int iInd = spThr->jobIndex();
+    disconnect(spThr.data(), &Thread::signalJobDone, this, &JobManager::handleJobFinished);
+    m_vspAbandoned.append(spThr);
+
+    auto spNew = createThread(iThr);
+    m_vThreads[iThr] = spNew;
+    m_quIdle.enqueue(spNew);
+
+    const JobPointer& spJob = m_vspJobs[iInd];
+    spJob->m_token.setParent(nullptr);
+    spJob->stop();
+    spJob->m_iError.storeRelease(jeTimeout);
+    --m_iRunning;
+    countFinishedUnsafe(iInd);
+    ++m_iErrors;
+    m_vTimedOut.append(iInd);
+    if (m_hashSpeculated.contains(iInd) == true) {
+        m_hashDuplicate[m_hashSpeculated.take(iInd)]->stop();
+    }
+    qWarning() << "JobManager: job" << iInd << spJob->name() << "exceeded its deadline of"
+               << effectiveTimeout(iInd) << "ms";
+
+    if (m_bReportJobFinish == true) {
+        emit signalJobFinished(spJob);
+    }
+    if (m_bOrderedRelease == true) {
+        releaseOrdered(iInd);
+    }
+    if (m_eErrorPolicy != jepWait) {
+        dropDependentsUnsafe(iInd);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+QSharedPointer<Thread> JobManager::createThread(int iSlot)
+{
+    auto spThr = QSharedPointer<Thread>(new Thread(iSlot, m_eIdleProfile));
+    spThr->setJobDoneHandler([this](Thread* pThr) { return continueInThread(pThr); });
+    return spThr;
 }
 
 //-----------------------------------------------------------------------------
@@ -311,7 +1644,7 @@ void JobManager::allocateThreads(int iT)
     //m_vIndex.clear();
 
     for (int i = 0; i < iT; ++i) {
-        auto spThr = QSharedPointer<Thread>(new Thread);
+        auto spThr = createThread(i);
         m_vThreads.append(spThr);
         m_quIdle.enqueue(spThr);
        // m_vIndex.append(-1);
@@ -334,10 +1667,63 @@ bool JobManager::handleError()
 
 //-----------------------------------------------------------------------------
 
-void JobManager::appendJobUnsafe(QSharedPointer<AbstractJob> spJob)
+void JobManager::appendJobUnsafe(JobPointer&& spJob)
 {
+    if (spJob->cost() > 0) {
+        m_bCostHints = true;
+    }
+    if ((m_eStatus == sRunning) && (m_vCost.count() == m_vspJobs.count())) {
+        double dCost = estimatedCostUnsafe(spJob.data());
+        m_vCost.append(dCost);
+        m_dTotalCost += dCost;
+        if (m_vRank.count() == m_vspJobs.count()) {
+            // the dependents of jobs appended during processing are not known yet
+            m_vRank.append(dCost);
+        }
+    }
     m_quWaiting.enqueue(m_vspJobs.count());
-    m_vspJobs.append(spJob);
+    m_iWaitingDepth.fetchAndAddRelease(1);
+    m_vspJobs.append(std::move(spJob));
+}
+
+//-----------------------------------------------------------------------------
+
+int JobManager::collectSubmittedUnsafe()
+{
+    QVector<AbstractJob*> vpJobs;
+    // the jobs are counted as waiting before they are taken, so waitingCount() does
+    // not drop below the limit, while they are moved into the queue
+    int iCounted = m_quSubmitted.count();
+    m_iWaitingDepth.fetchAndAddRelease(iCounted);
+    int iCnt = m_quSubmitted.takeAll(vpJobs);
+    m_vspJobs.reserve(m_vspJobs.count() + iCnt);
+    for (int i = 0; i < iCnt; ++i) {
+        appendJobUnsafe(JobPointer(vpJobs[i]));
+    }
+    m_iWaitingDepth.fetchAndAddRelease(-iCounted);
+    return iCnt;
+}
+
+//-----------------------------------------------------------------------------
+
+void JobManager::releaseOrdered(int iInd)
+{
+    m_setRelease.insert(iInd);
+    int iReleased = m_iReleased.loadAcquire();
+    while (m_setRelease.remove(iReleased) == true) {
+        emit signalJobReleased(iReleased, m_vspJobs[iReleased]);
+        m_iReleased.storeRelease(++iReleased);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+bool JobManager::isInReleaseWindow(int iInd) const
+{
+    if ((m_bOrderedRelease == false) || (m_iReleaseWindow <= 0)) {
+        return true;
+    }
+    return iInd < m_iReleased.loadAcquire() + m_iReleaseWindow;
 }
 
 //-----------------------------------------------------------------------------
@@ -16,10 +16,20 @@
 #include <QQueue>
 #include <QTimer>
 #include <QMutex>
+#include <QWaitCondition>
+#include <QSet>
+#include <QHash>
+#include <QByteArray>
 #include <QSharedPointer>
+#include <QElapsedTimer>
+
+#include <exception>
 
 #include "abstractjob.h"
+#include "abstractschedulingpolicy.h"
+#include "submissionqueue.h"
 #include "thread.h"
+#include "timerwheel.h"
 
 namespace thr {
 
@@ -38,6 +48,28 @@ enum JobManagerError {
     jmeUserDefined = 1000,          //!< values greater than this are reserved for user defined errors
 };
 
+/**
+ * @brief The JobErrorPolicy enum. This enum describes, what JobManager does with
+ * the jobs, which depend directly or transitively on a job, which finished with
+ * an error
+ */
+enum JobErrorPolicy {
+    jepWait,                        //!< dependent jobs are left in the queue; they can never be started
+    jepCancelDependents,            //!< dependent jobs are cancelled at once and counted as failed jobs
+    jepSkipDependents,              //!< dependent jobs are marked as skipped and processing continues
+};
+
+/**
+ * @brief The OverflowPolicy enum. This enum describes, what JobManager does with the
+ * jobs appended during the processing, when the queue of waiting jobs is full (see
+ * JobManager::setOverflowPolicy())
+ */
+enum OverflowPolicy {
+    opQueue,                        //!< the job is queued anyway; the queue is not limited
+    opCallerRuns,                   //!< the job is processed at once by the thread, which appends it
+    opBlock,                        //!< the thread, which appends the job, waits until the queue has space
+};
+
 /**
  * @brief The JobManager class. This class is used to process several jobs at once,
  * each one in a separate thread.
@@ -53,6 +85,20 @@ enum JobManagerError {
  * job and there are still queued jobs left, but none of them can be started,
  * JobManager will emit signal signalError() with jmeNoJobReady parameter.<br/><br/>
  *
+ * By default, the jobs, which depend on a job, which finished with an error, can never
+ * be started, so they are left in the queue. The error policy can be changed with
+ * setErrorPolicy(). With jepCancelDependents, all the transitive dependents of a
+ * failed job are cancelled as soon as the job fails. They are never processed and
+ * they are counted as failed jobs, so the processing ends as soon as the number of
+ * allowed errors is exceeded. With jepSkipDependents, the transitive dependents are
+ * marked as skipped (see AbstractJob::isSkipped()) and the processing of the
+ * independent jobs continues. In both cases, the dependents are counted as finished
+ * jobs.<br/><br/>
+ *
+ * Which of the jobs, which can be started, is started next and which idle thread
+ * processes it, is decided by the scheduling policy (see setSchedulingPolicy()). By
+ * default, the jobs are started in the order they were appended. <br/><br/>
+ *
  * Even though there is no limitation (besides the physical memory available) on the number
  * of jobs assigned to the job manager, one has to be careful not to exaggerate, because
  * AbstractJob class is derived from QObject and QObject creation and removal from memory
@@ -64,7 +110,11 @@ enum JobManagerError {
  * the number of jobs, which failed to be processed correctly, exceeds the
  * number of allowed errors, JobManager will not process any other queued jobs and
  * will wait until all the threads finish processing and then it will emit
- * signal signalError() with jmeTooManyErrors parameter. If JobManager
+ * signal signalError() with jmeTooManyErrors parameter. Jobs, which threw an
+ * exception from their process() method, are counted as failed jobs as well. The
+ * first such exception is kept and rethrown by wait(). A failed job is not counted,
+ * if its retry policy (see AbstractJob::retryPolicy()) allows another attempt;
+ * instead, it is queued again after the backoff delay. If JobManager
  * finishes processing and the number of failed jobs does not exceed the number
  * of allowed errors, signal signalFinished() is emitted.<br/><br/>
  * User can stop the JobManager processing by calling stop() method. The JobManager
@@ -72,21 +122,38 @@ enum JobManagerError {
  * processing the remaining queued jobs. In this case, after all threads are finished,
  * JobManager will emit signal signalStopped(). <br/><br/>
  *
- * JobManager can report progress, which is calculated as a percentage of finished
- * jobs in regard to the total number of jobs scheduled. User can set the interval
+ * JobManager can report progress, which is calculated as a percentage of the estimated
+ * processing time of the finished jobs (see AbstractJob::setCost()) in regard to the
+ * estimated processing time of all the jobs scheduled. If no costs are set, this is
+ * the percentage of finished jobs. User can set the interval
  * at which the progress is reported via signal signalProcess() with
  * setProgressReportTimeout method. By default, JobManager does not report
  * progress. <br/><br/>
  *
  * JobManager takes ownership of all the jobs appended to it via append() method and
  * all the jobs that are spawned from the previously finished jobs, storing
- * them with the shared pointers. Every job will be deleted by JobManager destructor
+ * them with the JobPointer objects. Every job will be deleted by JobManager destructor
  * or the clear() method, unless it was retrieved from job() method and stored by
- * another shared pointer. <br/><br/>
+ * another JobPointer. <br/><br/>
  *
  * Additional threads can be added to JobManager even during the job processing with
  * addThreads() method. <br/><br/>
  *
+ * Jobs can be appended from any thread, including the threads processing other jobs
+ * of the same JobManager. Jobs appended from a thread other than the one JobManager
+ * lives in are passed through a lock-free submission queue and become visible in the
+ * vector of jobs (and in jobCount()) once the JobManager's thread collects them, which
+ * happens as soon as its event loop runs, when any job finishes or when start() is
+ * called. <br/><br/>
+ *
+ * If the results of the jobs have to be consumed in the same order as the jobs were
+ * appended, ordered release can be turned on with setOrderedRelease() method. JobManager
+ * will then buffer the jobs, which finished out of order, and emit signal
+ * signalJobReleased() for every job as soon as all the jobs with smaller indices
+ * have been released. The size of the release window limits how far beyond the
+ * oldest unreleased job the processing is allowed to proceed, which caps the number
+ * of buffered results. <br/><br/>
+ *
  * @code
 class TestJob : public thr::AbstractJob
 {
@@ -151,6 +218,8 @@ class JobManager : public QObject
 {
     Q_OBJECT
 
+    friend class SchedulingQueue;
+
     /**
      * @brief The Status enum. This internal structure holds the status of the
      * current (or latest) operation performed by the JobManager
@@ -196,11 +265,46 @@ public:
     {   return m_bReportJobFinish; }
 
     /**
-     * @brief job. Returns the shared pointer to the i-th job
+     * @brief setOrderedRelease. Turns the ordered release of finished jobs on or off.
+     * If ordered release is on, JobManager will emit signal signalJobReleased() for
+     * every finished job in the order of job indices, as soon as all the jobs with
+     * smaller indices have finished. This method should only be called when
+     * JobManager is idle.
+     * @param bOrdered. True to turn the ordered release on and false otherwise
+     * @param iWindow. Size of the release window. A job will not be started, if its
+     * index is not smaller than the index of the oldest unreleased job plus iWindow.
+     * If this is less or equal to 0, the window is unlimited. Note that with a limited
+     * window, a job should only depend on the jobs with smaller indices.
+     */
+    void setOrderedRelease(bool bOrdered, int iWindow = 0);
+    /**
+     * @brief isOrderedRelease. Returns true, if ordered release of finished jobs is on
+     * @return true, if ordered release of finished jobs is on and false otherwise
+     */
+    bool isOrderedRelease() const
+    {   return m_bOrderedRelease; }
+    /**
+     * @brief releaseWindow. Returns the size of the release window
+     * @return size of the release window. If it is less or equal to 0, the window
+     * is unlimited
+     */
+    int releaseWindow() const
+    {   return m_iReleaseWindow; }
+    /**
+     * @brief releasedCount. Returns the number of jobs released in order so far
+     * This method is thread safe, so the jobs can read it while they are processed
+     * @return number of jobs released in order. This is also the index of the
+     * next job to be released
+     */
+    int releasedCount() const
+    {   return m_iReleased.loadAcquire(); }
+
+    /**
+     * @brief job. Returns the pointer to the i-th job
      * @param i. Job index
-     * @return read only shared pointer to the i-th job object
+     * @return read only pointer to the i-th job object
      */
-    const QSharedPointer<AbstractJob> job(int i) const
+    const JobPointer job(int i) const
     {   return m_vspJobs.at(i); }
 
     /**
@@ -208,7 +312,7 @@ public:
      * processed. JobManager always takes
      * ownership of this job object and deletes it in destructor
      * or when clear() method is called, unless it was retrieved from job() method
-     * and stored by another shared pointer. Before being appended to the
+     * and stored by another JobPointer. Before being appended to the
      * JobManager, a job object has to be created on the heap!
      * @code
      * class TestJob : public thr::AbstractJob
@@ -225,13 +329,66 @@ public:
      * jm.append(&job);             // wrong, will crash the application
      * jm.append(new TestJob);      // correct
      * @endcode
+     * This method is thread safe. If it is called from a thread other than the one
+     * JobManager lives in, it never blocks, unless the overflow policy says so (see
+     * setOverflowPolicy()). In that case, the job object has to be
+     * created in the calling thread, since it is moved into the JobManager's thread.
      * @param pJob pointer to the job object.
      */
     void appendJob(AbstractJob* pJob);
+    /**
+     * @brief appendJobs. Appends all the given jobs to the vector of jobs to be
+     * processed at once. This is equivalent to calling appendJob() for each job,
+     * but the storage is reserved only once and the whole batch is published with
+     * a single synchronization operation, which makes a difference when lots of
+     * jobs are appended.
+     * @param vpJobs vector of pointers to the job objects. JobManager takes
+     * ownership of all of them.
+     */
+    void appendJobs(const QVector<AbstractJob*>& vpJobs);
+    /**
+     * @brief appendJobs. Appends all the jobs in the range [itFirst, itLast) to the
+     * vector of jobs to be processed at once.
+     * @param itFirst iterator pointing to the pointer to the first job to append
+     * @param itLast iterator pointing past the pointer to the last job to append
+     */
+    template <typename Iterator>
+    void appendJobs(Iterator itFirst, Iterator itLast)
+    {
+        QVector<AbstractJob*> vpJobs;
+        for (; itFirst != itLast; ++itFirst) {
+            vpJobs.append(*itFirst);
+        }
+        appendJobs(vpJobs);
+    }
     /**
      * @brief clear. Deletes all the jobs in the job queue and makes the queue empty.
      */
     void clear();
+    /**
+     * @brief markFinished. Marks the job as already finished, so it is counted, but
+     * not processed, when the processing is started. This is used to resume the work
+     * done in an earlier run, for instance from a checkpoint. It has no effect while
+     * the processing is running
+     * @param iInd. Index of the job in the queue
+     */
+    void markFinished(int iInd);
+    /**
+     * @brief invalidate. Marks the job and all the jobs depending on it, directly or
+     * through other jobs, as not finished. The jobs are kept after the processing is
+     * finished, so when start() is called again, only the invalidated jobs (and the
+     * ones which did not finish successfully) are processed; the results of the other
+     * jobs are reused. Call it after the input of the job has changed. A job has to
+     * reset its result at the beginning of process(), since it can be processed more
+     * than once. If an invalidated job reads a value from an input port, which was
+     * freed after the previous run (see OutputPort), the producer of the value is
+     * invalidated as well. The jobs spawned by an invalidated job in the previous run
+     * are not removed, so this is not suitable for jobs spawning other jobs. It has no
+     * effect while the processing is running
+     * @param iInd. Index of the changed job
+     * @return number of finished jobs, which have to be processed again
+     */
+    int invalidate(int iInd);
     /**
      * @brief setAllowedErrors. Sets the number of jobs, that are allowed to
      * finish processing with an error.
@@ -247,6 +404,261 @@ public:
      */
     int allowedErrors() const
     {   return m_iAllowedErrors; }
+    /**
+     * @brief setErrorPolicy. Sets the policy, which determines what happens to the
+     * jobs, which depend on a job, which finished with an error. The default policy
+     * is jepWait.
+     * @param ePolicy. New error policy
+     */
+    void setErrorPolicy(JobErrorPolicy ePolicy);
+    /**
+     * @brief errorPolicy. Returns the error policy
+     * @return error policy
+     */
+    JobErrorPolicy errorPolicy() const
+    {   return m_eErrorPolicy; }
+    /**
+     * @brief droppedCount. Returns the number of jobs, which were cancelled or
+     * skipped because of the error policy
+     * @return number of cancelled or skipped jobs
+     */
+    int droppedCount() const
+    {   return m_iDropped; }
+    /**
+     * @brief setJobTimeout. Sets the deadline for processing of every job, which has
+     * no deadline of its own (see AbstractJob::setTimeout()). When a job exceeds its
+     * deadline, the watchdog stops the job, counts it as failed with the error code
+     * jeTimeout, emits signalJobTimeout() and continues processing the other jobs
+     * with a new thread. The thread processing the expired job is abandoned and
+     * released as soon as the job returns.
+     * @param iMS. Deadline in [ms]. If it is 0 or negative, jobs without a deadline
+     * of their own are not watched. The default value is 0.
+     */
+    void setJobTimeout(int iMS);
+    /**
+     * @brief jobTimeout. Returns the deadline for processing of jobs without a
+     * deadline of their own
+     * @return deadline in [ms]
+     */
+    int jobTimeout() const
+    {   return m_iJobTimeout; }
+    /**
+     * @brief timedOutJobs. Returns the indices of the jobs, which exceeded their
+     * deadline since the processing was started
+     * @return vector of job indices in the order of expiry
+     */
+    QVector<int> timedOutJobs() const;
+    /**
+     * @brief retryCount. Returns the number of failed attempts, which were retried
+     * since the processing was started
+     * @return number of retries
+     */
+    int retryCount() const
+    {   return m_iRetries; }
+    /**
+     * @brief setSpeculation. Turns the speculative processing of stragglers on or off.
+     * If it is on and there are idle threads, because no queued job can be started,
+     * the watchdog looks for idempotent jobs (see AbstractJob::setIdempotent()), which
+     * are running much longer than the median processing time of the finished jobs
+     * of the same class. A duplicate of such a job is created with AbstractJob::clone()
+     * and processed in an idle thread. The first copy to finish wins: if the original
+     * finishes first, the duplicate is stopped; if the duplicate finishes first, the
+     * original is stopped and then takes over the result with
+     * AbstractJob::adoptResult().
+     * @param bSpeculation. True to turn the speculation on and false otherwise
+     * @param dFactor. A job is a straggler, if it runs longer than dFactor times
+     * the median processing time
+     * @param iMinSamples. Minimal number of finished jobs of the same class needed
+     * to compute the median
+     */
+    void setSpeculation(bool bSpeculation, double dFactor = 3.0, int iMinSamples = 5);
+    /**
+     * @brief isSpeculation. Returns true, if the speculative processing is on
+     * @return true, if the speculative processing is on and false otherwise
+     */
+    bool isSpeculation() const
+    {   return m_bSpeculation; }
+    /**
+     * @brief speculatedCount. Returns the number of duplicates launched since the
+     * processing was started
+     * @return number of launched duplicates
+     */
+    int speculatedCount() const
+    {   return m_iSpeculated; }
+    /**
+     * @brief speculationWins. Returns the number of duplicates, which finished before
+     * their originals since the processing was started
+     * @return number of duplicates, which won
+     */
+    int speculationWins() const
+    {   return m_iSpeculationWins; }
+    /**
+     * @brief setSchedulingPolicy. Sets the scheduling policy, which decides which of
+     * the jobs, which can be started, is started next and which idle thread processes
+     * it (see AbstractSchedulingPolicy). The default policy is FifoPolicy. The policy
+     * can be changed during the processing as well; it is used for the jobs started
+     * after the change.
+     * @param pPolicy. Pointer to the policy object created on the heap. JobManager takes
+     * ownership of it! If it is null pointer, FifoPolicy is used
+     */
+    void setSchedulingPolicy(AbstractSchedulingPolicy* pPolicy);
+    /**
+     * @brief schedulingPolicy. Returns the current scheduling policy
+     * @return pointer to the current scheduling policy, owned by JobManager
+     */
+    AbstractSchedulingPolicy* schedulingPolicy() const;
+    /**
+     * @brief setCriticalPathScheduling. Turns the critical path scheduling on or off.
+     * This is a shortcut for setting the CriticalPathPolicy scheduling policy. If it is
+     * on, JobManager computes the upward rank of every job: the estimated processing
+     * time of the job (see AbstractJob::setCost()) plus the largest rank of the jobs,
+     * which depend on it. Among the jobs, which can be started, the one with the
+     * highest rank, that is the one on the longest remaining path through the
+     * dependency graph, is started first. The rank of a job appended during the
+     * processing is its own estimated processing time.
+     * @param bCriticalPath. True to turn the critical path scheduling on and false to
+     * start the jobs in the order they were appended (FifoPolicy)
+     */
+    void setCriticalPathScheduling(bool bCriticalPath);
+    /**
+     * @brief isCriticalPathScheduling. Returns true, if the critical path scheduling is on
+     * @return true, if the current scheduling policy is CriticalPathPolicy and false
+     * otherwise
+     */
+    bool isCriticalPathScheduling() const;
+    /**
+     * @brief rank. Returns the upward rank of the job with the given index
+     * @param iInd job index
+     * @return upward rank in [ms] or 0, if the ranks are not computed
+     */
+    double rank(int iInd) const;
+    /**
+     * @brief setLongestFirstScheduling. Turns the longest job first scheduling on or
+     * off. This is a shortcut for setting the LongestFirstPolicy scheduling policy. If
+     * it is on, the job with the largest estimated processing time (see
+     * AbstractJob::setCost()) is started first among the jobs, which can be started,
+     * so a long job appended last does not extend the total processing time.
+     * @param bLongestFirst. True to turn the longest job first scheduling on and false
+     * to start the jobs in the order they were appended (FifoPolicy)
+     */
+    void setLongestFirstScheduling(bool bLongestFirst);
+    /**
+     * @brief isLongestFirstScheduling. Returns true, if the longest job first
+     * scheduling is on
+     * @return true, if the current scheduling policy is LongestFirstPolicy and false
+     * otherwise
+     */
+    bool isLongestFirstScheduling() const;
+    /**
+     * @brief setContinuationDepth. Sets the maximal length of the chain of
+     * continuations processed by one thread. When a job finishes and one of the jobs,
+     * which depend on it, can be started because of that, this continuation is started
+     * at once in the thread, which has just finished, regardless of the scheduling
+     * policy. This saves looking the job up in the queue and keeps the continuation in
+     * the thread of its dependency, as LocalityPolicy does. When the chain reaches the
+     * maximal length, the next job for the thread is selected by the scheduling policy
+     * again, so long chains cannot starve the other jobs. <br/>
+     * When the finished job succeeded and the continuation needs no watchdog (no
+     * deadline and no speculation), the thread finishes the job and starts the
+     * continuation itself, without waiting for the JobManager's thread. This is not
+     * done, if the finished jobs are reported (see setReportJobFinish() and
+     * setOrderedRelease()), so signalJobFinished() and signalJobReleased() are always
+     * emitted from the JobManager's thread, nor if the finished job spawns jobs, so
+     * the jobs are only ever appended in the JobManager's thread.
+     * @param iDepth. Maximal number of continuations started one after another in the
+     * same thread. If it is 0 (default), continuations are not started directly
+     */
+    void setContinuationDepth(int iDepth);
+    /**
+     * @brief continuationDepth. Returns the maximal length of the chain of
+     * continuations processed by one thread
+     * @return maximal length of the chain of continuations
+     */
+    int continuationDepth() const
+    {   return m_iContinuationDepth.loadAcquire(); }
+    /**
+     * @brief continuedCount. Returns the number of jobs, which were started as
+     * continuations since the processing was started
+     * @return number of continuations started
+     */
+    int continuedCount() const
+    {   return m_iContinued; }
+    /**
+     * @brief setOverflowPolicy. Sets, what happens with the jobs appended with
+     * appendJob() during the processing, when the number of waiting jobs reaches the
+     * given limit. With opCallerRuns, the job is processed at once by the calling
+     * thread and handed over to JobManager already processed, so a producer, which
+     * appends jobs faster than they are processed, slows down to the pace of the
+     * processing. A job, which cannot be started yet because of its dependencies, is
+     * queued anyway. With opBlock, the calling thread waits until the number of
+     * waiting jobs drops below the limit. The JobManager's thread and the threads
+     * processing the jobs are never blocked, since they have to keep the processing
+     * going; their jobs are queued instead. The jobs appended with appendJobs() are
+     * always queued.
+     * @param ePolicy. Overflow policy. The default policy is opQueue
+     * @param iMaxWaiting. Maximal number of waiting jobs. If it is 0 or negative, the
+     * queue is not limited
+     */
+    void setOverflowPolicy(OverflowPolicy ePolicy, int iMaxWaiting = 0);
+    /**
+     * @brief overflowPolicy. Returns the overflow policy
+     * @return overflow policy
+     */
+    OverflowPolicy overflowPolicy() const
+    {   return static_cast<OverflowPolicy>(m_iOverflowPolicy.loadAcquire()); }
+    /**
+     * @brief maxWaiting. Returns the maximal number of waiting jobs
+     * @return maximal number of waiting jobs or 0, if the queue is not limited
+     */
+    int maxWaiting() const
+    {   return m_iMaxWaiting.loadAcquire(); }
+    /**
+     * @brief waitingCount. Returns the number of jobs waiting to be started, including
+     * the jobs appended from other threads, which were not collected yet. This method
+     * is thread safe and never blocks
+     * @return approximate number of waiting jobs
+     */
+    int waitingCount() const
+    {   return m_iWaitingDepth.loadAcquire() + m_quSubmitted.count(); }
+    /**
+     * @brief setResultCache. Sets the cache for the results of the deterministic jobs
+     * (see AbstractJob::cacheKey()). A job found in the cache is not processed; its
+     * result is loaded from the cache instead. The cache can be shared by several job
+     * managers and kept between the runs
+     * @param pCache. Pointer to the result cache. The JobManager does not take the
+     * ownership; the cache has to exist while the jobs are processed. If it is null,
+     * no results are cached
+     */
+    void setResultCache(ResultCache* pCache)
+    {   m_pCache = pCache; }
+    /**
+     * @brief resultCache. Returns the result cache
+     * @return pointer to the result cache or null pointer, if there is none
+     */
+    ResultCache* resultCache() const
+    {   return m_pCache; }
+    /**
+     * @brief setIdleProfile. Sets the idle profile of all the threads. The threads
+     * are kept running between the jobs; the profile decides how long an idle thread
+     * spins and yields before it sleeps (see Thread). ipLowLatency starts the next
+     * job fastest, but uses processor time while the threads are waiting, ipPowerSaving
+     * puts the idle threads to sleep at once. The default profile is ipBalanced.
+     * @param eProfile. New idle profile
+     */
+    void setIdleProfile(IdleProfile eProfile);
+    /**
+     * @brief idleProfile. Returns the idle profile of the threads
+     * @return idle profile
+     */
+    IdleProfile idleProfile() const
+    {   return m_eIdleProfile; }
+    /**
+     * @brief estimatedRemainingTime. Estimates the time needed to finish the processing
+     * from the time spent so far and the estimated processing times of the finished
+     * and the remaining jobs
+     * @return estimated remaining time in [ms] or -1, if no job has finished yet
+     */
+    qint64 estimatedRemainingTime() const;
 
     /**
      * @brief setProgressReportTimeout. Sets the time interval at which the progress
@@ -271,8 +683,8 @@ public:
     void addThreads(int iT);
     /**
      * @brief threadsRunningCount. Returns the number of threads, which are
-     * actually running
-     * @return number of threads, which are actually running
+     * actually processing a job
+     * @return number of threads, which are actually processing a job
      */
     int threadsRunningCount() const;
 
@@ -312,10 +724,11 @@ public:
     {   return m_vspJobs.count(); }
     /**
      * @brief finishedCount. Returns the number of finished jobs
-     * @return number of finished jobs
+     * @return number of finished jobs. This method is thread safe and never blocks,
+     * so it can be called from the slots connected to any signal of JobManager
      */
     int finishedCount() const
-    {   return m_iFinished; }
+    {   return m_iFinished.loadAcquire(); }
 
     /**
      * @brief isRunning. Returns true, if at least one job is still running.
@@ -329,7 +742,46 @@ public:
      * @return true, if the processing was stopped from outside and false otherwise
      */
     bool isStopped() const
-    {   return m_bStop; }
+    {   return m_token.isCancelled(); }
+    /**
+     * @brief isPaused. Returns true, if the processing is paused
+     * @return true, if the processing is paused and false otherwise
+     */
+    bool isPaused() const
+    {   return m_gate.isClosed(); }
+    /**
+     * @brief stopLatency. Returns the time between the call of the stop() method and
+     * the moment when the last running job has finished
+     * @return stop latency in milliseconds or -1, if the processing was not stopped
+     */
+    int stopLatency() const
+    {   return m_iStopLatency; }
+    /**
+     * @brief cancellationToken. Returns the cancellation token of this JobManager.
+     * The tokens of the running jobs are children of this token, so cancelling it
+     * stops all the running jobs. If this token is attached to another token as a
+     * child, cancelling the parent token stops the processing as well.
+     * @return reference to the cancellation token
+     */
+    CancellationToken& cancellationToken()
+    {   return m_token; }
+    /**
+     * @brief exception. Returns the first exception thrown from the process() method
+     * of any job since the processing was started
+     * @return first exception thrown or null pointer, if no job threw an exception
+     */
+    std::exception_ptr exception() const
+    {   return m_exception; }
+    /**
+     * @brief wait. Processes events until the processing is finished, stopped or
+     * until it ends with an error. This method has to be called from the thread
+     * this object lives in. If any job threw an exception from its process() method,
+     * the first such exception is rethrown.
+     * @param iMS maximal time to wait in [ms]. If it is negative, there is no limit
+     * @return true, if the processing is not running anymore and false, if the
+     * time limit expired first
+     */
+    bool wait(int iMS = -1);
 
 public slots:
     /**
@@ -342,6 +794,22 @@ public slots:
      * @brief stop. Stops all the processing threads
      */
     void stop();
+    /**
+     * @brief pause. Pauses the processing. No new jobs are started and the running
+     * jobs wait at their next CHECK_JOB_PAUSE() yield point, so their threads do not
+     * use the processor anymore; the jobs without yield points finish normally. No
+     * processing done so far is lost. The time spent paused counts towards the job
+     * deadlines (see setJobTimeout()), but the watchdog does not stop any job while
+     * the processing is paused. The pause only lasts until the end of the current
+     * processing: start() always starts unpaused, also after the paused processing
+     * was stopped.
+     */
+    void pause();
+    /**
+     * @brief resume. Resumes the paused processing. The waiting jobs continue and
+     * the idle threads start processing the queued jobs again
+     */
+    void resume();
 
 signals:
     /**
@@ -350,13 +818,35 @@ signals:
     void signalFinished();
     /**
      * @brief signalJobFinished. If report job finish flag is set to true,
-     * JobManager will emit this signal every time one job has finished the processing
-     * successfully.
+     * JobManager will emit this signal every time a job is taken out of processing:
+     * when it finished successfully or with an error, when it exceeded its deadline
+     * (see setJobTimeout()) and when it was skipped or cancelled, because a job it
+     * depends on failed (see setErrorPolicy()). The cases are told apart by the job:
+     * isFinished() is true only for a successful job, isSkipped() for a skipped job,
+     * errorCode() is jeTimeout for an expired job and isStopped() is true for a
+     * cancelled one.
      * If the report job finish flag is set to false, this signal will not be emitted
-     * at all.
-     * @param pJob pointer to the job, which processing just finished successfully
+     * at all. The signal is emitted from the JobManager's thread.
+     * @param spJob pointer to the job, which was taken out of processing
+     */
+    void signalJobFinished(const thr::JobPointer& spJob);
+    /**
+     * @brief signalJobReleased. If ordered release is turned on, JobManager will
+     * emit this signal for every finished job in the order of job indices. The
+     * signal is emitted regardless of whether the job finished successfully or with
+     * an error. The signal is emitted from the JobManager's thread.
+     * @param iInd index of the released job
+     * @param spJob pointer to the released job
+     */
+    void signalJobReleased(int iInd, const thr::JobPointer& spJob);
+    /**
+     * @brief signalJobTimeout. Emitted when the job exceeded its deadline and was
+     * stopped by the watchdog. The lock is not held while it is emitted, so the slots
+     * can call timedOutJobs()
+     * @param iInd index of the expired job
+     * @param spJob pointer to the expired job
      */
-    void signalJobFinished(QSharedPointer<thr::AbstractJob> spJob);
+    void signalJobTimeout(int iInd, const thr::JobPointer& spJob);
     /**
      * @brief signalError. Emitted when the number of errors exceeds the number
      * of allowed errors and all threads became idle afterwards
@@ -371,7 +861,7 @@ signals:
     /**
      * @brief signalProgress. This signal will be emitted in regular time intervals
      * to report progress
-     * @param iPer percentage of finished jobs
+     * @param iPer percentage of finished jobs, weighted by their costs, if any job has a cost set
      */
     void signalProgress(int iPer);
 
@@ -385,10 +875,41 @@ protected slots:
     /**
      * @brief reportProgress. Reports the progress by emitting signalProgress signal.
      * Progress is reported as a percentage of finished jobs in regard to the
-     * total number of jobs scheduled for processing
+     * total number of jobs scheduled for processing. If any job has a cost set (see
+     * AbstractJob::setCost()), the jobs are weighted by their estimated costs
      */
     virtual void reportProgress();
 
+private slots:
+    /**
+     * @brief collectSubmitted. Collects the jobs, which were appended from other
+     * threads, and starts them, if processing is under way and there are idle
+     * threads available
+     */
+    void collectSubmitted();
+    /**
+     * @brief startWaiting. Starts the waiting jobs in the idle threads, if processing
+     * is under way
+     */
+    void startWaiting();
+    /**
+     * @brief collectInline. Collects the jobs, which were processed by the threads
+     * appending them, and finishes them
+     */
+    void collectInline();
+    /**
+     * @brief checkTimeouts. Called periodically by the watchdog timer while jobs
+     * with deadlines are processed. Stops every job, which exceeded its deadline,
+     * and replaces its thread with a new one
+     */
+    void checkTimeouts();
+    /**
+     * @brief retryJob. Queues the job with the given index again, after its backoff
+     * delay has expired
+     * @param iInd job index
+     */
+    void retryJob(int iInd);
+
 private:
     /**
      * @brief checkNext. Checks if next job can be started and if yes, it will
@@ -396,6 +917,21 @@ private:
      * @param iThrIndex index of an idle thread, where new job will be started
      */
     void checkNext();
+    /**
+     * @brief throttle. Applies the overflow policy to the job, which is being appended
+     * @param pJob pointer to the job
+     * @return true, if the job was processed by the calling thread and false, if it
+     * should be queued
+     */
+    bool throttle(AbstractJob* pJob);
+    /**
+     * @brief completeJobUnsafe. Collects the spawned jobs, counts the job as finished
+     * or schedules its retry and starts the next jobs without locking mutex
+     * @param iInd index of the job, which returned from processing
+     * @param spThr pointer to the thread, which processed the job or null pointer, if
+     * it was processed by the thread, which appended it
+     */
+    void completeJobUnsafe(int iInd, const QSharedPointer<Thread>& spThr);
     /**
      * @brief startNext. Starts the next job
      */
@@ -419,7 +955,203 @@ private:
      * locking mutex
      * @param spJob. Pointer to the job object to append
      */
-    void appendJobUnsafe(QSharedPointer<AbstractJob> spJob);
+    void appendJobUnsafe(JobPointer&& spJob);
+    /**
+     * @brief collectSubmittedUnsafe. Moves the jobs from the submission queue
+     * to the vector of jobs without locking mutex
+     * @return number of collected jobs
+     */
+    int collectSubmittedUnsafe();
+    /**
+     * @brief releaseOrdered. Stores the index of finished job into the release
+     * buffer and emits signal signalJobReleased() for every job at the beginning of
+     * the buffer, which has no unfinished jobs with smaller indices
+     * @param iInd index of the finished job
+     */
+    void releaseOrdered(int iInd);
+    /**
+     * @brief isInReleaseWindow. Checks, if the job with the given index is allowed to
+     * be started according to the release window
+     * @param iInd job index
+     * @return true, if the job is allowed to be started and false otherwise
+     */
+    bool isInReleaseWindow(int iInd) const;
+    /**
+     * @brief dropDependentsUnsafe. Removes all the queued jobs, which depend directly
+     * or transitively on the failed job, from the queue and cancels or skips them
+     * according to the error policy without locking mutex
+     * @param iInd index of the failed job
+     */
+    void dropDependentsUnsafe(int iInd);
+    /**
+     * @brief effectiveTimeout. Returns the deadline of the job with the given index
+     * @param iInd job index
+     * @return deadline of the job in [ms] or 0, if the job has no deadline
+     */
+    int effectiveTimeout(int iInd) const;
+    /**
+     * @brief scheduleRetryUnsafe. Checks the retry policy of the failed job and
+     * schedules another attempt, if the policy allows it, without locking mutex
+     * @param iInd index of the failed job
+     * @return true, if another attempt was scheduled and false otherwise
+     */
+    bool scheduleRetryUnsafe(int iInd);
+    /**
+     * @brief armWatchdogUnsafe. Starts the watchdog timer, if it is not running yet
+     * or if it is running with a longer interval, without locking mutex
+     * @param iInterval watchdog interval in [ms]
+     */
+    void armWatchdogUnsafe(int iInterval);
+    /**
+     * @brief recordRunTimeUnsafe. Adds the processing time of the finished job to
+     * the statistics of its class without locking mutex
+     * @param pJob pointer to the finished job
+     */
+    void recordRunTimeUnsafe(const AbstractJob* pJob);
+    /**
+     * @brief medianRunTimeUnsafe. Returns the median processing time of the finished
+     * jobs of the same class as the given job without locking mutex
+     * @param pJob pointer to the job
+     * @param iMinSamples minimal number of samples
+     * @return median processing time in [ms] or -1, if there are not enough samples
+     */
+    qint64 medianRunTimeUnsafe(const AbstractJob* pJob, int iMinSamples) const;
+    /**
+     * @brief isStragglerUnsafe. Checks, if the thread with the given index is processing
+     * an idempotent job, which is running much longer than its peers and is not
+     * duplicated yet, without locking mutex
+     * @param iThr thread index
+     * @return true, if the job should be duplicated and false otherwise
+     */
+    bool isStragglerUnsafe(int iThr) const;
+    /**
+     * @brief launchDuplicateUnsafe. Starts a duplicate of the job processed by the
+     * thread with the given index in an idle thread without locking mutex
+     * @param iThr thread index
+     */
+    void launchDuplicateUnsafe(int iThr);
+    /**
+     * @brief handleDuplicateFinishedUnsafe. Handles the thread, which finished
+     * processing a duplicate, without locking mutex
+     * @param spThr pointer to the thread
+     */
+    void handleDuplicateFinishedUnsafe(const QSharedPointer<Thread>& spThr);
+    /**
+     * @brief takeNextJobUnsafe. Removes the next job, which can be started, from the
+     * queue without locking mutex
+     * @return index of the job or -1, if no queued job can be started
+     */
+    int takeNextJobUnsafe();
+    /**
+     * @brief takeIdleThreadUnsafe. Removes the idle thread, which the scheduling
+     * policy selects for the given job, from the queue of idle threads without
+     * locking mutex
+     * @param pJob pointer to the job
+     * @return pointer to the thread
+     */
+    QSharedPointer<Thread> takeIdleThreadUnsafe(const AbstractJob* pJob);
+    /**
+     * @brief startJobUnsafe. Starts processing the job in the given thread without
+     * locking mutex
+     * @param iInd job index
+     * @param spThr pointer to the thread, which is not in the queue of idle threads
+     */
+    void startJobUnsafe(int iInd, const QSharedPointer<Thread>& spThr);
+    /**
+     * @brief startContinuationUnsafe. Starts the first job, which depends on the given
+     * finished job and can be started now, in the idle thread, which processed the
+     * finished job, without locking mutex
+     * @param iInd index of the finished job
+     * @param spThr pointer to the thread, which processed the finished job
+     * @return true, if a continuation was started and false otherwise
+     */
+    bool startContinuationUnsafe(int iInd, const QSharedPointer<Thread>& spThr);
+    /**
+     * @brief findContinuationUnsafe. Returns the first waiting job, which depends on
+     * the given job and can be started, as soon as the given job is finished, without
+     * locking mutex
+     * @param iInd index of the finished job
+     * @param iSlot slot index of the thread, which processed the finished job
+     * @return index of the continuation or -1, if there is none or the chain of the
+     * thread is too long
+     */
+    int findContinuationUnsafe(int iInd, int iSlot);
+    /**
+     * @brief continueInThread. Job done handler of the threads: finishes the returned
+     * job and starts its continuation from the thread, which processed the job. It
+     * gives up, if the mutex is locked
+     * @param pThr pointer to the thread
+     * @return true, if the continuation was started and false, if the job is left to
+     * handleJobFinished()
+     */
+    bool continueInThread(Thread* pThr);
+    /**
+     * @brief continueInThreadUnsafe. Does the work of continueInThread() without
+     * locking mutex
+     * @param pThr pointer to the thread
+     * @return true, if the continuation was started and false otherwise
+     */
+    bool continueInThreadUnsafe(Thread* pThr);
+    /**
+     * @brief finishJobUnsafe. Counts the job, which returned and is not retried, as
+     * finished, collects the jobs it spawned and reports it, without locking mutex
+     * @param iInd job index
+     */
+    void finishJobUnsafe(int iInd);
+    /**
+     * @brief takeSpawnedJobUnsafe. Returns the next job spawned by the given job, which
+     * may have been taken already by the thread, which processed it, without locking
+     * mutex
+     * @param iInd job index
+     * @return pointer to the next spawned job or null pointer, if there are no more
+     */
+    AbstractJob* takeSpawnedJobUnsafe(int iInd);
+    /**
+     * @brief startWaitingUnsafe. Does the work of startWaiting() without locking mutex
+     */
+    void startWaitingUnsafe();
+    /**
+     * @brief createThread. Creates a thread for the given slot
+     * @param iSlot slot index of the thread
+     * @return pointer to the thread
+     */
+    QSharedPointer<Thread> createThread(int iSlot);
+    /**
+     * @brief updateDependentsUnsafe. Adds the jobs appended since the last call to the
+     * lists of dependents without locking mutex
+     */
+    void updateDependentsUnsafe();
+    /**
+     * @brief estimatedCostUnsafe. Returns the estimated processing time of the job
+     * without locking mutex. If the job has no cost set, the median processing time of
+     * the finished jobs of the same class is used, or 1, if there are none
+     * @param pJob pointer to the job
+     * @return estimated processing time in [ms]
+     */
+    double estimatedCostUnsafe(const AbstractJob* pJob) const;
+    /**
+     * @brief computeRanksUnsafe. Computes the upward rank of every job without
+     * locking mutex
+     */
+    void computeRanksUnsafe();
+    /**
+     * @brief computeCostsUnsafe. Estimates the processing time of every job and the
+     * total processing time without locking mutex
+     */
+    void computeCostsUnsafe();
+    /**
+     * @brief countFinishedUnsafe. Counts the job with the given index as finished,
+     * without locking mutex
+     * @param iInd job index
+     */
+    void countFinishedUnsafe(int iInd);
+    /**
+     * @brief abandonThreadUnsafe. Stops the job processed by the thread with the given
+     * index, counts it as timed out and replaces the thread with a new one without
+     * locking mutex. The caller emits signalJobTimeout() after unlocking mutex
+     * @param iThr thread index
+     */
+    void abandonThreadUnsafe(int iThr);
 
 protected:
     /**
@@ -431,13 +1163,23 @@ protected:
      */
     QQueue<QSharedPointer<Thread> > m_quIdle;
     /**
-     * @brief m_vspJobs. Vector of shared pointers to jobs to process
+     * @brief m_vspJobs. Vector of pointers to jobs to process
      */
-    QVector<QSharedPointer<AbstractJob> > m_vspJobs;
+    QVector<JobPointer> m_vspJobs;
     /**
      * @brief m_quWaiting. Vector of job indices waiting to be started
      */
     QQueue<int> m_quWaiting;
+    /**
+     * @brief m_iWaitingDepth. Number of jobs in the queue of waiting jobs, which can
+     * be read without locking mutex
+     */
+    QAtomicInt m_iWaitingDepth;
+    /**
+     * @brief m_quSubmitted. Lock-free queue of jobs appended from other threads,
+     * which were not yet collected into the vector of jobs
+     */
+    SubmissionQueue<AbstractJob*> m_quSubmitted;
     /**
      * @brief m_timer. Timer for reporting progress
      */
@@ -453,7 +1195,7 @@ protected:
     /**
      * @brief m_iFinished. Number of finished jobs
      */
-    int m_iFinished;
+    QAtomicInt m_iFinished;
     /**
      * @brief m_mutex. Synchronization object
      */
@@ -471,6 +1213,187 @@ protected:
      * @brief m_iErrors. Number of jobs, which processing resulted in an error
      */
     int m_iErrors;
+    /**
+     * @brief m_exception. First exception thrown from the process() method of any job
+     */
+    std::exception_ptr m_exception;
+    /**
+     * @brief m_eErrorPolicy. Determines, what happens to the dependents of a failed
+     * job
+     */
+    JobErrorPolicy m_eErrorPolicy;
+    /**
+     * @brief m_iDropped. Number of jobs cancelled or skipped because of the error
+     * policy
+     */
+    int m_iDropped;
+    /**
+     * @brief m_iJobTimeout. Deadline for processing of jobs without a deadline of
+     * their own in [ms]
+     */
+    int m_iJobTimeout;
+    /**
+     * @brief m_timerWatchdog. Timer, which checks the deadlines of the running jobs
+     */
+    QTimer m_timerWatchdog;
+    /**
+     * @brief m_vspAbandoned. Threads, which are still processing expired jobs
+     */
+    QVector<QSharedPointer<Thread> > m_vspAbandoned;
+    /**
+     * @brief m_wheelRetry. Timer wheel, which holds the failed jobs until their
+     * backoff delay expires
+     */
+    TimerWheel m_wheelRetry;
+    /**
+     * @brief m_iRetrying. Number of failed jobs waiting for another attempt
+     */
+    int m_iRetrying;
+    /**
+     * @brief m_iRetries. Number of retries since the processing was started
+     */
+    int m_iRetries;
+    /**
+     * @brief m_bSpeculation. If this flag is set to true, duplicates of straggling
+     * idempotent jobs are processed in idle threads
+     */
+    bool m_bSpeculation;
+    /**
+     * @brief m_dSpeculationFactor. A job is a straggler, if it runs longer than this
+     * factor times the median processing time
+     */
+    double m_dSpeculationFactor;
+    /**
+     * @brief m_iSpeculationSamples. Minimal number of samples needed to compute the
+     * median processing time
+     */
+    int m_iSpeculationSamples;
+    /**
+     * @brief m_iSpeculated. Number of launched duplicates
+     */
+    int m_iSpeculated;
+    /**
+     * @brief m_iSpeculationWins. Number of duplicates, which finished first
+     */
+    int m_iSpeculationWins;
+    /**
+     * @brief m_spPolicy. Scheduling policy
+     */
+    QSharedPointer<AbstractSchedulingPolicy> m_spPolicy;
+    /**
+     * @brief m_iContinuationDepth. Maximal length of the chain of continuations
+     * processed by one thread
+     */
+    QAtomicInt m_iContinuationDepth;
+    /**
+     * @brief m_iContinued. Number of continuations started
+     */
+    int m_iContinued;
+    /**
+     * @brief m_eIdleProfile. Idle profile of the threads
+     */
+    IdleProfile m_eIdleProfile;
+    /**
+     * @brief m_iOverflowPolicy. Overflow policy, which is read without locking mutex
+     */
+    QAtomicInt m_iOverflowPolicy;
+    /**
+     * @brief m_iMaxWaiting. Maximal number of waiting jobs, which is read without
+     * locking mutex
+     */
+    QAtomicInt m_iMaxWaiting;
+    /**
+     * @brief m_iInline. Number of jobs being processed by the threads appending them
+     */
+    int m_iInline;
+    /**
+     * @brief m_quInline. Lock-free queue of jobs processed by the threads appending
+     * them, which were not yet collected into the vector of jobs
+     */
+    SubmissionQueue<AbstractJob*> m_quInline;
+    /**
+     * @brief m_gate. Pause gate handed to every job started
+     */
+    PauseGate m_gate;
+    /**
+     * @brief m_pCache. Result cache handed to every job started
+     */
+    ResultCache* m_pCache;
+    /**
+     * @brief m_condSpace. Signalled when a waiting job is started, so the threads
+     * blocked by the overflow policy can check the queue again
+     */
+    QWaitCondition m_condSpace;
+    /**
+     * @brief m_vChain. Length of the current chain of continuations of every thread
+     * slot
+     */
+    QVector<int> m_vChain;
+    /**
+     * @brief m_vvDependents. Indices of the jobs, which depend on every job
+     */
+    QVector<QVector<int> > m_vvDependents;
+    /**
+     * @brief m_hashIndex. Index of every job, which is in the lists of dependents
+     */
+    QHash<const AbstractJob*, int> m_hashIndex;
+    /**
+     * @brief m_vRank. Upward rank of every job
+     */
+    QVector<double> m_vRank;
+    /**
+     * @brief m_vCost. Estimated processing time of every job
+     */
+    QVector<double> m_vCost;
+    /**
+     * @brief m_dTotalCost. Sum of the estimated processing times of all the jobs
+     */
+    double m_dTotalCost;
+    /**
+     * @brief m_dFinishedCost. Sum of the estimated processing times of the finished jobs
+     */
+    double m_dFinishedCost;
+    /**
+     * @brief m_bCostHints. True, if any job has a cost set, so the progress is weighted
+     * by the estimated costs
+     */
+    bool m_bCostHints;
+    /**
+     * @brief m_timerRun. Measures the time since the processing was started
+     */
+    QElapsedTimer m_timerRun;
+    /**
+     * @brief m_hashMedian. Cached median processing times for every job class
+     */
+    mutable QHash<QByteArray, qint64> m_hashMedian;
+    /**
+     * @brief m_hashRunTimes. Recent processing times of finished jobs for every
+     * job class
+     */
+    QHash<QByteArray, QVector<qint64> > m_hashRunTimes;
+    /**
+     * @brief m_hashDuplicate. Duplicates for every thread, which is processing one
+     */
+    QHash<Thread*, JobPointer> m_hashDuplicate;
+    /**
+     * @brief m_hashSpeculated. Threads processing the duplicates for every job index,
+     * while both the original and the duplicate are running
+     */
+    QHash<int, Thread*> m_hashSpeculated;
+    /**
+     * @brief m_hashWinner. Duplicates, which finished first, for every job index,
+     * until the original stops
+     */
+    QHash<int, JobPointer> m_hashWinner;
+    /**
+     * @brief m_hashSpawned. The first job spawned by every job, which was finished by
+     * its own thread, until the JobManager's thread collects it
+     */
+    QHash<int, AbstractJob*> m_hashSpawned;
+    /**
+     * @brief m_vTimedOut. Indices of the jobs, which exceeded their deadline
+     */
+    QVector<int> m_vTimedOut;
     /**
      * @brief m_eStatus. This variable denotes the current status of the object
      */
@@ -482,16 +1405,46 @@ protected:
 
 private:
     /**
-     * @brief m_bStop. This flag indicates, whether there have been a request to
-     * stop processing.
+     * @brief m_token. Cancellation token, which indicates, whether there have been a
+     * request to stop processing.
+     */
+    CancellationToken m_token;
+    /**
+     * @brief m_timerStop. Measures the time since the stop() method was called
+     */
+    QElapsedTimer m_timerStop;
+    /**
+     * @brief m_iStopLatency. Time in milliseconds between the stop request and the
+     * moment, when the last running job finished
      */
-    bool m_bStop;
+    int m_iStopLatency;
     /**
      * @brief m_bReportJobFinish. If this flag is set to true, the JobManager
      * will report every finished job by emitting signal signalJobFinished().
      * The default value of this flag is false.
      */
     bool m_bReportJobFinish;
+    /**
+     * @brief m_bOrderedRelease. If this flag is set to true, the JobManager will
+     * release finished jobs in order of their indices by emitting signal
+     * signalJobReleased(). The default value of this flag is false.
+     */
+    bool m_bOrderedRelease;
+    /**
+     * @brief m_iReleaseWindow. Size of the release window. If it is less or
+     * equal to 0, the window is unlimited.
+     */
+    int m_iReleaseWindow;
+    /**
+     * @brief m_iReleased. Number of jobs released in order, which is also the
+     * index of the next job to release
+     */
+    QAtomicInt m_iReleased;
+    /**
+     * @brief m_setRelease. Indices of finished jobs, which are waiting for the
+     * jobs with smaller indices to finish before they are released
+     */
+    QSet<int> m_setRelease;
 };
 
 }   // namespace
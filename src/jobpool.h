@@ -0,0 +1,264 @@
+#ifndef JOBPOOL_H
+#define JOBPOOL_H
+
+/************************************************************************************
+ *                                                                                  *
+ *  Project:     ThreadingLib                                                       *
+ *  File:        jobpool.h                                                          *
+ *  Class:       JobPool, PooledJob                                                 *
+ *  Author:      Bojan Kverh                                                        *
+ *  License:     LGPL                                                               *
+ *                                                                                  *
+ ************************************************************************************/
+
+#include <new>
+#include <cstddef>
+
+#include <QMutex>
+#include <QVector>
+
+namespace thr {
+
+/**
+ * @brief The JobPool class. This class is a typed free-list pool, which recycles
+ * the memory of job objects of type T.
+ *
+ * @details Every thread keeps its own cache of free memory blocks, so allocating
+ * and releasing a job normally does not need any synchronization at all. When a
+ * thread cache grows too large, half of it is moved into a shared depot, and when
+ * a thread cache is empty, it is refilled from the depot in one batch. Only when
+ * the depot is empty as well, the memory is requested from the global allocator.
+ * <br/><br/>
+ * The memory is never returned to the global allocator on its own. Since
+ * JobManager::clear() deletes all the jobs at once, e.g. when AbstractSessionManager
+ * starts the next session, the memory of all the jobs of the previous session is
+ * kept in the pool and reused for the jobs of the next session. Call trim() to
+ * release the memory, when it is not needed anymore. <br/><br/>
+ * The pool is not used directly. Instead, the job class should inherit from
+ * PooledJob as well as from AbstractJob.
+ */
+template <typename T>
+class JobPool
+{
+    /**
+     * @brief The Depot struct. This structure holds the free memory blocks shared
+     * among all the threads
+     */
+    struct Depot
+    {
+        ~Depot()
+        {
+            for (int i = 0; i < m_vpFree.count(); ++i) {
+                ::operator delete(m_vpFree[i]);
+            }
+        }
+
+        /**
+         * @brief give. Moves the last iN blocks from the vector into the depot
+         * @param rvpFree. Vector of free blocks
+         * @param iN. Number of blocks to move
+         */
+        void give(QVector<void*>& rvpFree, int iN)
+        {
+            QMutexLocker locker(&m_mutex);
+            int iFirst = rvpFree.count() - iN;
+            for (int i = iFirst; i < rvpFree.count(); ++i) {
+                m_vpFree.append(rvpFree[i]);
+            }
+            rvpFree.resize(iFirst);
+        }
+
+        /**
+         * @brief take. Moves at most iN blocks from the depot into the vector
+         * @param rvpFree. Vector of free blocks
+         * @param iN. Maximal number of blocks to move. If it is negative, all the
+         * blocks are moved
+         */
+        void take(QVector<void*>& rvpFree, int iN)
+        {
+            QMutexLocker locker(&m_mutex);
+            int iFirst = (iN < 0)? 0 : qMax(0, m_vpFree.count() - iN);
+            for (int i = iFirst; i < m_vpFree.count(); ++i) {
+                rvpFree.append(m_vpFree[i]);
+            }
+            m_vpFree.resize(iFirst);
+        }
+
+        /**
+         * @brief m_mutex. Synchronization object
+         */
+        QMutex m_mutex;
+        /**
+         * @brief m_vpFree. Free memory blocks
+         */
+        QVector<void*> m_vpFree;
+    };
+
+    /**
+     * @brief The LocalCache struct. This structure holds the free memory blocks
+     * of one thread. When the thread exits, its blocks are moved into the depot.
+     */
+    struct LocalCache
+    {
+        ~LocalCache()
+        {
+            JobPool<T>::depot().give(m_vpFree, m_vpFree.count());
+        }
+
+        /**
+         * @brief m_vpFree. Free memory blocks
+         */
+        QVector<void*> m_vpFree;
+    };
+
+public:
+    /**
+     * @brief The Limits enum. Sizes of batches moved between the thread caches and
+     * the depot
+     */
+    enum Limits {
+        lBatch = 64,            //!< number of blocks moved between a thread cache and the depot at once
+    };
+
+    /**
+     * @brief allocate. Allocates memory for one object
+     * @param uiSize. Size of the object. If it is not equal to sizeof(T), which
+     * happens for classes derived from T, the global allocator is used
+     * @return pointer to the allocated memory
+     */
+    static void* allocate(std::size_t uiSize)
+    {
+        if (uiSize != sizeof(T)) {
+            return ::operator new(uiSize);
+        }
+
+        QVector<void*>& rvpFree = localCache().m_vpFree;
+        if (rvpFree.isEmpty() == true) {
+            depot().take(rvpFree, lBatch);
+        }
+        if (rvpFree.isEmpty() == true) {
+            return ::operator new(uiSize);
+        }
+        void* p = rvpFree.last();
+        rvpFree.removeLast();
+        return p;
+    }
+
+    /**
+     * @brief release. Returns the memory of one object into the pool
+     * @param p. Pointer to the memory
+     * @param uiSize. Size of the object
+     */
+    static void release(void* p, std::size_t uiSize)
+    {
+        if (uiSize != sizeof(T)) {
+            ::operator delete(p);
+            return;
+        }
+
+        QVector<void*>& rvpFree = localCache().m_vpFree;
+        rvpFree.append(p);
+        if (rvpFree.count() >= 2*lBatch) {
+            depot().give(rvpFree, lBatch);
+        }
+    }
+
+    /**
+     * @brief reserve. Makes sure that at least iN memory blocks are available in
+     * the depot, so that the jobs can be created without calling the global allocator
+     * @param iN. Number of memory blocks
+     */
+    static void reserve(int iN)
+    {
+        QVector<void*> vpFree;
+        depot().take(vpFree, iN);
+        while (vpFree.count() < iN) {
+            vpFree.append(::operator new(sizeof(T)));
+        }
+        depot().give(vpFree, vpFree.count());
+    }
+
+    /**
+     * @brief trim. Releases all the memory blocks in the depot and in the cache
+     * of the calling thread back to the global allocator
+     */
+    static void trim()
+    {
+        QVector<void*>& rvpFree = localCache().m_vpFree;
+        depot().take(rvpFree, -1);
+        for (int i = 0; i < rvpFree.count(); ++i) {
+            ::operator delete(rvpFree[i]);
+        }
+        rvpFree.clear();
+    }
+
+    /**
+     * @brief freeCount. Returns the number of free memory blocks in the cache of the
+     * calling thread
+     * @return number of free memory blocks
+     */
+    static int freeCount()
+    {   return localCache().m_vpFree.count(); }
+
+private:
+    /**
+     * @brief localCache. Returns the cache of the calling thread
+     * @return cache of the calling thread
+     */
+    static LocalCache& localCache()
+    {
+        static thread_local LocalCache cache;
+        return cache;
+    }
+
+    /**
+     * @brief depot. Returns the cache shared among all the threads
+     * @return cache shared among all the threads
+     */
+    static Depot& depot()
+    {
+        static Depot depot;
+        return depot;
+    }
+};
+
+/**
+ * @brief The PooledJob class. Inherit from this class in addition to AbstractJob in
+ * order to allocate the job objects of type T from JobPool.
+ *
+ * @details This is useful when lots of jobs of the same type are created, for
+ * example when jobs are spawned recursively. Nothing else changes in the way the jobs
+ * are created, appended to JobManager or deleted:
+ * @code
+class JobSort : public thr::AbstractJob, public thr::PooledJob<JobSort>
+{
+    Q_OBJECT
+    ...
+};
+
+JobSort* pJob = new JobSort(paiN, 0, N - 1);    // memory comes from JobPool<JobSort>
+ * @endcode
+ */
+template <typename T>
+class PooledJob
+{
+public:
+    /**
+     * @brief operator new. Allocates the memory for the job from the pool
+     * @param uiSize. Size of the job object
+     * @return pointer to the allocated memory
+     */
+    static void* operator new(std::size_t uiSize)
+    {   return JobPool<T>::allocate(uiSize); }
+    /**
+     * @brief operator delete. Returns the memory of the job into the pool
+     * @param p. Pointer to the memory
+     * @param uiSize. Size of the job object
+     */
+    static void operator delete(void* p, std::size_t uiSize)
+    {   JobPool<T>::release(p, uiSize); }
+};
+
+}   // namespace
+
+#endif // JOBPOOL_H
@@ -1,4 +1,8 @@
 #include <QDebug>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QSemaphore>
 
 #include "jobqueue.h"
 
@@ -6,25 +10,53 @@ namespace thr {
 
 //-----------------------------------------------------------------------------
 
+/**
+ * @brief The JobQueueWorker class. This runnable is used to help processing
+ * the jobs of the parallel job queue in a thread from the global thread pool
+ */
+class JobQueueWorker : public QRunnable
+{
+public:
+    JobQueueWorker(JobQueue* pQueue, QSemaphore* pDone)
+    {
+        m_pQueue = pQueue;
+        m_pDone = pDone;
+    }
+
+    void run()
+    {
+        m_pQueue->processItems();
+        m_pDone->release();
+    }
+
+private:
+    JobQueue* m_pQueue;
+    QSemaphore* m_pDone;
+};
+
+//-----------------------------------------------------------------------------
+
 JobQueue::JobQueue() : AbstractJob()
 {
-    m_iCurrent = -1;
+    m_iCurrent.storeRelease(-1);
+    m_bParallel = false;
+    m_iThreads = 0;
+    m_iFirstOrdered = 0;
 }
 
 //-----------------------------------------------------------------------------
 
 JobQueue::~JobQueue()
 {
+    collectSubmitted();
     m_vJobs.clear();
 }
 
 //-----------------------------------------------------------------------------
 
-void JobQueue::append(AbstractJob* pJob)
+void JobQueue::append(AbstractJob* pJob, bool bOrdered)
 {
-    QMutexLocker locker(&m_mutex);
-    QSharedPointer<AbstractJob> spJob(pJob);
-    m_vJobs.append(spJob);
+    m_quSubmitted.push(qMakePair(pJob, bOrdered));
 }
 
 //-----------------------------------------------------------------------------
@@ -32,20 +64,48 @@ void JobQueue::append(AbstractJob* pJob)
 void JobQueue::clear()
 {
     QMutexLocker locker(&m_mutex);
-    m_iCurrent = -1;
+    collectSubmitted();
+    QMutexLocker lockerJobs(&m_mutexJobs);
+    m_iCurrent.storeRelease(-1);
     m_vJobs.clear();
+    m_vOrdered.clear();
+}
+
+//-----------------------------------------------------------------------------
+
+int JobQueue::jobCount() const
+{
+    QMutexLocker locker(&m_mutexJobs);
+    return m_vJobs.count() + m_quSubmitted.count();
 }
 
 //-----------------------------------------------------------------------------
 
 int JobQueue::progress() const
 {
-    if (m_iCurrent < 0)
+    QMutexLocker locker(&m_mutexJobs);
+    // the current index is read once, since the processing thread keeps changing it
+    int iCurrent = m_iCurrent.loadAcquire();
+    if (m_bParallel == true) {
+        if (m_vJobs.count() == 0)
+            return (iCurrent < 0)? 0 : 100;
+        return 100*m_iProcessed.loadAcquire()/m_vJobs.count();
+    }
+
+    if (iCurrent < 0)
         return 0;
-    else if (m_iCurrent >= m_vJobs.count())
+    else if (iCurrent >= m_vJobs.count())
         return 100;
 
-    return (100*m_iCurrent + m_vJobs[m_iCurrent]->progress())/m_vJobs.count();
+    return (100*iCurrent + m_vJobs[iCurrent]->progress())/m_vJobs.count();
+}
+
+//-----------------------------------------------------------------------------
+
+void JobQueue::setParallel(bool bParallel, int iThreads)
+{
+    m_bParallel = bParallel;
+    m_iThreads = iThreads;
 }
 
 //-----------------------------------------------------------------------------
@@ -53,16 +113,162 @@ int JobQueue::progress() const
 void JobQueue::process()
 {
     QMutexLocker locker(&m_mutex);
-    for (m_iCurrent = 0; (m_iCurrent < m_vJobs.count()) && (m_iError == 0); ++m_iCurrent) {
-        CHECK_JOB_STOP();
-        m_vJobs[m_iCurrent]->process();
-        if (m_vJobs[m_iCurrent]->errorCode() > 0) {
-            m_iError = m_vJobs[m_iCurrent]->errorCode();
+    collectSubmitted();
+    if (m_bParallel == true) {
+        processParallel();
+        return;
+    }
+
+    m_iCurrent.storeRelease(0);
+    for (int i = 0; m_iError.loadAcquire() == 0; m_iCurrent.storeRelease(++i)) {
+        if ((i == m_vJobs.count()) && (collectSubmitted() == 0)) {
+            break;
+        }
+        // the queue can be paused between its jobs
+        CHECK_JOB_PAUSE();
+        m_vJobs[i]->m_pGate = m_pGate;
+        m_vJobs[i]->m_pCache = m_pCache;
+        m_vJobs[i]->m_token.setParent(&m_token);
+        m_vJobs[i]->processCached();
+        m_vJobs[i]->m_token.setParent(nullptr);
+        if (m_vJobs[i]->errorCode() != 0) {
+            m_iError.storeRelease(m_vJobs[i]->errorCode());
+            m_exception = m_vJobs[i]->exception();
         }
     }
 }
 
 //-----------------------------------------------------------------------------
 
-}   // namespace
+void JobQueue::processParallel()
+{
+    m_iCurrent.storeRelease(0);
+    m_iProcessed.storeRelease(0);
+    m_iFirstError.storeRelease(0);
 
+    int iThreads = m_iThreads;
+    if (iThreads <= 0) {
+        iThreads = QThread::idealThreadCount();
+    }
+
+    // jobs appended during processing are processed in the next round
+    int iFirst = 0;
+    do {
+        m_vItems.clear();
+        bool bOrdered = false;
+        for (int i = iFirst; i < m_vJobs.count(); ++i) {
+            if (m_vOrdered[i] == true) {
+                bOrdered = true;
+            }   else {
+                m_vItems.append(i);
+            }
+        }
+        if (bOrdered == true) {
+            // the chain of ordered jobs is claimed first, since it is likely the longest item
+            m_vItems.prepend(-1);
+        }
+        m_iFirstOrdered = iFirst;
+        iFirst = m_vJobs.count();
+        m_iNextItem.storeRelease(0);
+
+        int iHelpers = qMin(iThreads, m_vItems.count()) - 1;
+        QSemaphore semDone;
+        QVector<JobQueueWorker*> vpWorkers;
+        for (int i = 0; i < iHelpers; ++i) {
+            JobQueueWorker* pWorker = new JobQueueWorker(this, &semDone);
+            // the workers are deleted here, since the ones not started are taken back
+            pWorker->setAutoDelete(false);
+            vpWorkers.append(pWorker);
+            QThreadPool::globalInstance()->start(pWorker);
+        }
+        // this thread is working as well, so the queue progresses even if the pool is busy
+        processItems();
+        // the helpers still waiting for a pool thread are not needed anymore; waiting for
+        // them could dead-lock, when the pool is saturated, e.g. by nested parallel queues
+        int iStarted = 0;
+        for (int i = 0; i < vpWorkers.count(); ++i) {
+            if (QThreadPool::globalInstance()->tryTake(vpWorkers[i]) == false) {
+                ++iStarted;
+            }
+        }
+        if (iStarted > 0) {
+            semDone.acquire(iStarted);
+        }
+        qDeleteAll(vpWorkers);
+    }   while (
+                (isStopped() == false) &&
+                (m_iFirstError.loadAcquire() == 0) &&
+                (collectSubmitted() > 0)
+                );
+
+    m_iCurrent.storeRelease(m_vJobs.count());
+    m_iError.storeRelease(m_iFirstError.loadAcquire());
+    if (m_iError.loadAcquire() == jeException) {
+        for (int i = 0; (i < m_vJobs.count()) && (m_exception == nullptr); ++i) {
+            m_exception = m_vJobs[i]->exception();
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void JobQueue::processItems()
+{
+    while ((isStopped() == false) && (m_iFirstError.loadAcquire() == 0)) {
+        CHECK_JOB_PAUSE();
+        int iItem = m_iNextItem.fetchAndAddOrdered(1);
+        if (iItem >= m_vItems.count()) {
+            return;
+        }
+
+        if (m_vItems[iItem] >= 0) {
+            processJob(m_vItems[iItem]);
+            continue;
+        }
+
+        for (int i = m_iFirstOrdered; i < m_vJobs.count(); ++i) {
+            if ((isStopped() == true) || (m_iFirstError.loadAcquire() != 0)) {
+                return;
+            }
+            if (m_vOrdered[i] == true) {
+                processJob(i);
+            }
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void JobQueue::processJob(int i)
+{
+    m_vJobs[i]->m_pGate = m_pGate;
+    m_vJobs[i]->m_pCache = m_pCache;
+    m_vJobs[i]->m_token.setParent(&m_token);
+    m_vJobs[i]->processCached();
+    m_vJobs[i]->m_token.setParent(nullptr);
+    if (m_vJobs[i]->errorCode() != 0) {
+        m_iFirstError.testAndSetOrdered(0, m_vJobs[i]->errorCode());
+    }
+    m_iProcessed.fetchAndAddOrdered(1);
+}
+
+//-----------------------------------------------------------------------------
+
+int JobQueue::collectSubmitted()
+{
+    QVector<QPair<AbstractJob*, bool> > vJobs;
+    int iCnt = m_quSubmitted.takeAll(vJobs);
+    if (iCnt == 0) {
+        return 0;
+    }
+    QMutexLocker locker(&m_mutexJobs);
+    for (int i = 0; i < iCnt; ++i) {
+        m_vJobs.append(JobPointer(vJobs[i].first));
+        m_vOrdered.append(vJobs[i].second);
+    }
+    return iCnt;
+}
+
+//-----------------------------------------------------------------------------
+
+}   // namespace
@@ -13,9 +13,11 @@
 
 #include <QVector>
 #include <QMutex>
-#include <QSharedPointer>
+#include <QAtomicInt>
+#include <QPair>
 
 #include "abstractjob.h"
+#include "submissionqueue.h"
 
 namespace thr {
 
@@ -26,7 +28,9 @@ namespace thr {
  *
  * @details This class is useful, if there are a number of jobs, which need to be processed
  * sequentially one after another in a separate thread. To insert a job into the
- * list of jobs, use the append() method. Calling start() method will start processing
+ * list of jobs, use the append() method. The append() method never blocks, so jobs
+ * can be appended from any thread even while the queue is being processed; they will
+ * be processed after the jobs, which were appended before them. Calling start() method will start processing
  * jobs, starting with the first. After each job has finished, the next queued job
  * will be processed until there are no more queued jobs or until the error
  * occurs while processing a job. <br/><br/>
@@ -41,6 +45,13 @@ namespace thr {
  * If auto delete flag is set to true with setAutoDelete() method, destructor and
  * clear() method will physically delete all jobs currently held by this queue from
  * the memory. The default value of the auto delete flag is false. <br/><br/>
+ * If the queued jobs are independent of each other, the queue can be switched into
+ * parallel mode with setParallel() method. In parallel mode, the queued jobs are
+ * distributed among several threads from the global thread pool, while the queue
+ * itself still reports progress and errors as a single job. Jobs, which were appended
+ * with the ordered flag set to true, are still processed sequentially one after
+ * another in the order they were appended, but in parallel with the other
+ * jobs. <br/><br/>
  * This class is derived from AbstractJob, so it can be assigned to JobManager for
  * processing
  */
@@ -58,10 +69,14 @@ public:
      */
     virtual ~JobQueue();
     /**
-     * @brief append. Appends the given job to the job queue
+     * @brief append. Appends the given job to the job queue. This method is thread
+     * safe and never blocks, even when the queue is being processed.
      * @param pJob. Pointer to the abstract job object.
+     * @param bOrdered. If this flag is true, the job will be processed after all the
+     * previously appended ordered jobs, even when the queue is in parallel mode. In
+     * sequential mode, this flag has no effect.
      */
-    void append(AbstractJob* pJob);
+    void append(AbstractJob* pJob, bool bOrdered = false);
     /**
      * @brief clear. Deletes all the jobs from queue
      */
@@ -71,8 +86,7 @@ public:
      * @brief jobCount. Returns the number of jobs in the queue
      * @return number of jobs in the queue
      */
-    int jobCount() const
-    {   return m_vJobs.count(); }
+    int jobCount() const;
 
     /**
      * @brief progress. Returns the progress in [%]
@@ -80,25 +94,117 @@ public:
      */
     int progress() const;
 
+    /**
+     * @brief setParallel. Turns the parallel mode on or off. This method should not
+     * be called while the queue is being processed.
+     * @param bParallel. True to turn the parallel mode on and false otherwise
+     * @param iThreads. Maximal number of threads used to process the queued jobs,
+     * including the thread processing the queue itself. If this is less or equal
+     * to 0, the ideal number of threads for the underlying CPU will be used.
+     */
+    void setParallel(bool bParallel, int iThreads = 0);
+    /**
+     * @brief isParallel. Returns true, if the queue is in parallel mode
+     * @return true, if the queue is in parallel mode and false otherwise
+     */
+    bool isParallel() const
+    {   return m_bParallel; }
+
 protected:
     /**
      * @brief process. Processes all the queued jobs
      */
     void process();
 
+private:
+    /**
+     * @brief processParallel. Distributes the queued jobs among the threads of
+     * the global thread pool and processes them
+     */
+    void processParallel();
+    /**
+     * @brief processItems. Claims and processes work items until there are no
+     * work items left, an error occurs or the stop flag is set. This method
+     * is called from several threads at once in parallel mode.
+     */
+    void processItems();
+    /**
+     * @brief processJob. Processes the i-th queued job and records its error
+     * @param i. Job index
+     */
+    void processJob(int i);
+    /**
+     * @brief collectSubmitted. Moves the jobs from the submission queue to the
+     * vector of jobs
+     * @return number of collected jobs
+     */
+    int collectSubmitted();
+
+    friend class JobQueueWorker;
+
 protected:
     /**
-     * @brief m_mutex. Synchronization object
+     * @brief m_mutex. Synchronization object, which prevents clearing the queue
+     * while it is being processed
      */
     QMutex m_mutex;
     /**
-     * @brief m_vJobs. Vector of shared pointers to jobs
+     * @brief m_mutexJobs. Synchronization object, which prevents reading the vector of
+     * jobs from other threads, while the collected jobs are appended to it. The thread
+     * processing the queue is the only one changing the vector, so it reads the vector
+     * without locking
+     */
+    mutable QMutex m_mutexJobs;
+    /**
+     * @brief m_vJobs. Vector of pointers to jobs
+     */
+    QVector<JobPointer> m_vJobs;
+    /**
+     * @brief m_quSubmitted. Lock-free queue of appended jobs with their ordered
+     * flags, which were not yet moved to the vector of jobs
+     */
+    SubmissionQueue<QPair<AbstractJob*, bool> > m_quSubmitted;
+    /**
+     * @brief m_vOrdered. Ordered flags of the queued jobs
+     */
+    QVector<bool> m_vOrdered;
+    /**
+     * @brief m_iCurrent. Current processing job index. It is read by progress() from
+     * other threads
+     */
+    QAtomicInt m_iCurrent;
+    /**
+     * @brief m_bParallel. If this flag is set to true, the queued jobs are processed
+     * in parallel
+     */
+    bool m_bParallel;
+    /**
+     * @brief m_iThreads. Maximal number of threads used in parallel mode
+     */
+    int m_iThreads;
+
+private:
+    /**
+     * @brief m_vItems. Work items for parallel processing. Each item is either an
+     * index of unordered job or -1, which stands for all the ordered jobs
+     */
+    QVector<int> m_vItems;
+    /**
+     * @brief m_iFirstOrdered. Index of the first job of the current parallel round
+     */
+    int m_iFirstOrdered;
+    /**
+     * @brief m_iNextItem. Index of the next work item to claim
+     */
+    QAtomicInt m_iNextItem;
+    /**
+     * @brief m_iProcessed. Number of jobs processed in parallel mode
      */
-    QVector<QSharedPointer<AbstractJob> > m_vJobs;
+    QAtomicInt m_iProcessed;
     /**
-     * @brief m_iCurrent. Current processing job index
+     * @brief m_iFirstError. Error code of the first job, which failed in parallel mode
      */
-    int m_iCurrent;
+    QAtomicInt m_iFirstError;
 };
 
 }   // namespace
@@ -0,0 +1,57 @@
+#include <QDebug>
+
+#include "pausegate.h"
+
+namespace thr {
+
+//-----------------------------------------------------------------------------
+
+PauseGate::PauseGate()
+{
+    m_iClosed.storeRelease(0);
+}
+
+//-----------------------------------------------------------------------------
+
+void PauseGate::close()
+{
+    QMutexLocker locker(&m_mutex);
+    m_iClosed.storeRelease(1);
+}
+
+//-----------------------------------------------------------------------------
+
+void PauseGate::open()
+{
+    QMutexLocker locker(&m_mutex);
+    m_iClosed.storeRelease(0);
+    m_cond.wakeAll();
+}
+
+//-----------------------------------------------------------------------------
+
+void PauseGate::wakeAll()
+{
+    QMutexLocker locker(&m_mutex);
+    m_cond.wakeAll();
+}
+
+//-----------------------------------------------------------------------------
+
+bool PauseGate::pass(const CancellationToken& rToken)
+{
+    if (isClosed() == false) {
+        return rToken.isCancelled() == false;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    while ((isClosed() == true) && (rToken.isCancelled() == false)) {
+        // the timeout covers a token cancelled without going through the owner
+        m_cond.wait(&m_mutex, 100);
+    }
+    return rToken.isCancelled() == false;
+}
+
+//-----------------------------------------------------------------------------
+
+}   // namespace
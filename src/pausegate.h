@@ -0,0 +1,82 @@
+#ifndef PAUSEGATE_H
+#define PAUSEGATE_H
+
+/************************************************************************************
+ *                                                                                  *
+ *  Project:     ThreadingLib                                                       *
+ *  File:        pausegate.h                                                        *
+ *  Class:       PauseGate                                                          *
+ *  Author:      Bojan Kverh                                                        *
+ *  License:     LGPL                                                               *
+ *                                                                                  *
+ ************************************************************************************/
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include "cancellationtoken.h"
+
+namespace thr {
+
+/**
+ * @brief The PauseGate class. This class is used to hold the running jobs at their
+ * cooperative yield points while the processing is paused.
+ *
+ * @details JobManager owns a gate and hands it to every job it starts. When
+ * JobManager is paused, the gate is closed and every job, which reaches the
+ * CHECK_JOB_PAUSE() macro, waits at the gate until it is opened again or the job
+ * is stopped. Checking an open gate costs a single atomic load.
+ */
+class PauseGate
+{
+public:
+    /**
+     * @brief PauseGate. Default constructor. The gate is open
+     */
+    PauseGate();
+
+    /**
+     * @brief isClosed. Returns true, if the gate is closed
+     * @return true, if the processing is paused and false otherwise
+     */
+    bool isClosed() const
+    {   return m_iClosed.loadAcquire() != 0; }
+    /**
+     * @brief close. Closes the gate, so the jobs wait at their next yield point
+     */
+    void close();
+    /**
+     * @brief open. Opens the gate and lets all the waiting jobs continue
+     */
+    void open();
+    /**
+     * @brief wakeAll. Wakes all the waiting jobs, so the stopped ones can return
+     */
+    void wakeAll();
+    /**
+     * @brief pass. Waits while the gate is closed
+     * @param rToken. Cancellation token of the calling job. Waiting ends, when the
+     * token is cancelled
+     * @return true, if the gate is open and false, if the token was cancelled
+     */
+    bool pass(const CancellationToken& rToken);
+
+private:
+    /**
+     * @brief m_iClosed. Set to 1, while the gate is closed
+     */
+    QAtomicInt m_iClosed;
+    /**
+     * @brief m_mutex. Synchronization object
+     */
+    QMutex m_mutex;
+    /**
+     * @brief m_cond. The jobs wait on this condition
+     */
+    QWaitCondition m_cond;
+};
+
+}   // namespace
+
+#endif // PAUSEGATE_H
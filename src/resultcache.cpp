@@ -0,0 +1,128 @@
+#include <QDebug>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+
+#include "resultcache.h"
+
+namespace thr {
+
+//-----------------------------------------------------------------------------
+
+ResultCache::ResultCache(int iMaxMemory, const QString& qsDir) :
+    m_cache(iMaxMemory)
+{
+    m_iHits.storeRelease(0);
+    m_iMisses.storeRelease(0);
+    setDirectory(qsDir);
+}
+
+//-----------------------------------------------------------------------------
+
+void ResultCache::setMaxMemory(int iMaxMemory)
+{
+    QMutexLocker locker(&m_mutex);
+    m_cache.setMaxCost(iMaxMemory);
+}
+
+//-----------------------------------------------------------------------------
+
+int ResultCache::maxMemory() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_cache.maxCost();
+}
+
+//-----------------------------------------------------------------------------
+
+void ResultCache::setDirectory(const QString& qsDir)
+{
+    QMutexLocker locker(&m_mutex);
+    m_qsDir = qsDir;
+    if ((m_qsDir.isEmpty() == false) && (QDir().mkpath(m_qsDir) == false)) {
+        qWarning() << "ResultCache: could not create directory" << m_qsDir;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+QString ResultCache::directory() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_qsDir;
+}
+
+//-----------------------------------------------------------------------------
+
+bool ResultCache::find(const QByteArray& baKey, QByteArray& baResult)
+{
+    QMutexLocker locker(&m_mutex);
+    QByteArray* pResult = m_cache.object(baKey);
+    if (pResult != nullptr) {
+        baResult = *pResult;
+        m_iHits.ref();
+        return true;
+    }
+
+    QString qsFile = fileName(baKey);
+    locker.unlock();
+    // the file is read without holding the lock, so other threads are not held up
+    QFile file(qsFile);
+    if ((qsFile.isEmpty() == true) || (file.open(QIODevice::ReadOnly) == false)) {
+        m_iMisses.ref();
+        return false;
+    }
+    baResult = file.readAll();
+    file.close();
+
+    locker.relock();
+    m_cache.insert(baKey, new QByteArray(baResult), baResult.size());
+    m_iHits.ref();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void ResultCache::insert(const QByteArray& baKey, const QByteArray& baResult)
+{
+    QMutexLocker locker(&m_mutex);
+    // a result larger than the memory limit is not kept in memory
+    m_cache.insert(baKey, new QByteArray(baResult), baResult.size());
+    QString qsFile = fileName(baKey);
+    locker.unlock();
+
+    if (qsFile.isEmpty() == false) {
+        // the file appears at once, so a concurrent reader never sees a partial result
+        QSaveFile file(qsFile);
+        if (
+                (file.open(QIODevice::WriteOnly) == false) ||
+                (file.write(baResult) != baResult.size()) || (file.commit() == false)
+                ) {
+            qWarning() << "ResultCache: could not write" << qsFile;
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void ResultCache::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_cache.clear();
+}
+
+//-----------------------------------------------------------------------------
+
+QString ResultCache::fileName(const QByteArray& baKey) const
+{
+    if (m_qsDir.isEmpty() == true) {
+        return QString();
+    }
+    QByteArray baHash = QCryptographicHash::hash(baKey, QCryptographicHash::Sha1);
+    return QDir(m_qsDir).filePath(QString::fromLatin1(baHash.toHex()));
+}
+
+//-----------------------------------------------------------------------------
+
+}   // namespace
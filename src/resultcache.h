@@ -0,0 +1,137 @@
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+/************************************************************************************
+ *                                                                                  *
+ *  Project:     ThreadingLib                                                       *
+ *  File:        resultcache.h                                                      *
+ *  Class:       ResultCache                                                        *
+ *  Author:      Bojan Kverh                                                        *
+ *  License:     LGPL                                                               *
+ *                                                                                  *
+ ************************************************************************************/
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QCache>
+#include <QMutex>
+#include <QString>
+
+namespace thr {
+
+/**
+ * @brief The ResultCache class. This class holds the serialized results of the
+ * deterministic jobs, so a job with the same input does not have to be processed again.
+ *
+ * @details A job takes part in caching, if it reimplements AbstractJob::cacheKey(),
+ * AbstractJob::saveResult() and AbstractJob::loadResult(). When such a job is
+ * processed by a JobManager with a result cache (see JobManager::setResultCache()),
+ * its result is looked up first. On a hit, the result is loaded into the job and
+ * process() is not called; on a miss, the job is processed and its result is stored.
+ * The jobs in a JobQueue processed by such a JobManager are looked up the same way. <br/><br/>
+ * The results are kept in memory and the least recently used ones are dropped,
+ * when the memory limit is exceeded. If a directory is set, every result is also
+ * written into a file named after the SHA-1 hash of the key, so the results survive
+ * the end of the program. The cache can be used from several threads at once and
+ * can be shared among several job managers.
+ */
+class ResultCache
+{
+public:
+    /**
+     * @brief ResultCache. Constructor
+     * @param iMaxMemory. Maximal total size of the results kept in memory in [bytes]
+     * @param qsDir. Directory for the results kept on disk. If it is empty, the
+     * results are kept in memory only
+     */
+    ResultCache(int iMaxMemory = 64*1024*1024, const QString& qsDir = QString());
+
+    /**
+     * @brief setMaxMemory. Sets the maximal total size of the results kept in memory.
+     * The least recently used results are dropped, if the new limit is lower
+     * @param iMaxMemory. Maximal size in [bytes]
+     */
+    void setMaxMemory(int iMaxMemory);
+    /**
+     * @brief maxMemory. Returns the maximal total size of the results kept in memory
+     * @return maximal size in [bytes]
+     */
+    int maxMemory() const;
+    /**
+     * @brief setDirectory. Sets the directory for the results kept on disk. The
+     * directory is created, if it does not exist
+     * @param qsDir. Directory name. If it is empty, the results are kept in memory only
+     */
+    void setDirectory(const QString& qsDir);
+    /**
+     * @brief directory. Returns the directory for the results kept on disk
+     * @return directory name or an empty string
+     */
+    QString directory() const;
+
+    /**
+     * @brief find. Looks up the result with the given key, first in memory and then
+     * on disk
+     * @param baKey. Key of the result
+     * @param baResult. The serialized result is stored here on a hit
+     * @return true on a hit and false otherwise
+     */
+    bool find(const QByteArray& baKey, QByteArray& baResult);
+    /**
+     * @brief insert. Stores the result with the given key
+     * @param baKey. Key of the result
+     * @param baResult. Serialized result
+     */
+    void insert(const QByteArray& baKey, const QByteArray& baResult);
+    /**
+     * @brief clear. Drops all the results kept in memory. The results on disk are kept
+     */
+    void clear();
+
+    /**
+     * @brief hits. Returns the number of successful lookups
+     * @return number of hits
+     */
+    int hits() const
+    {   return m_iHits.loadAcquire(); }
+    /**
+     * @brief misses. Returns the number of unsuccessful lookups
+     * @return number of misses
+     */
+    int misses() const
+    {   return m_iMisses.loadAcquire(); }
+
+private:
+    /**
+     * @brief fileName. Returns the name of the file holding the result with the given key
+     * @param baKey. Key of the result
+     * @return file name or an empty string, if no directory is set
+     */
+    QString fileName(const QByteArray& baKey) const;
+
+private:
+    /**
+     * @brief m_cache. Results kept in memory; the cost of a result is its size
+     */
+    QCache<QByteArray, QByteArray> m_cache;
+    /**
+     * @brief m_qsDir. Directory for the results kept on disk
+     */
+    QString m_qsDir;
+    /**
+     * @brief m_iHits. Number of hits
+     */
+    QAtomicInt m_iHits;
+    /**
+     * @brief m_iMisses. Number of misses
+     */
+    QAtomicInt m_iMisses;
+    /**
+     * @brief m_mutex. Synchronization object
+     */
+    mutable QMutex m_mutex;
+};
+
+}   // namespace
+
+#endif // RESULTCACHE_H
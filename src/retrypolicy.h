@@ -0,0 +1,111 @@
+#ifndef RETRYPOLICY_H
+#define RETRYPOLICY_H
+
+/************************************************************************************
+ *                                                                                  *
+ *  Project:     ThreadingLib                                                       *
+ *  File:        retrypolicy.h                                                      *
+ *  Class:       RetryPolicy                                                        *
+ *  Author:      Bojan Kverh                                                        *
+ *  License:     LGPL                                                               *
+ *                                                                                  *
+ ************************************************************************************/
+
+#include <functional>
+
+#include <QtGlobal>
+
+namespace thr {
+
+/**
+ * @brief The RetryPolicy struct. This structure describes, how many times and when
+ * JobManager retries processing of a job, which finished with an error.
+ *
+ * @details The first attempt is the normal processing of the job. If it fails and
+ * the number of attempts is smaller than m_iMaxAttempts, the job is processed again
+ * after a delay. The delay starts at m_iInitialDelay and is multiplied by m_dMultiplier
+ * after every failed attempt, but it never exceeds m_iMaxDelay. If m_fnRetryOn is set,
+ * only the errors, for which it returns true, are retried. <br/><br/>
+ * The policy is returned by AbstractJob::retryPolicy(), so it can be set for the
+ * whole job class by reimplementing that method:
+ * @code
+thr::RetryPolicy JobDownload::retryPolicy() const
+{
+    thr::RetryPolicy policy(5, 100);
+    policy.m_fnRetryOn = [](int iErr) { return iErr == eConnectionLost; };
+    return policy;
+}
+ * @endcode
+ */
+struct RetryPolicy
+{
+    /**
+     * @brief RetryPolicy. Constructor
+     * @param iMaxAttempts. Maximal number of attempts, including the first one. The
+     * default value 1 means that failed jobs are not retried
+     * @param iInitialDelay. Delay before the first retry in [ms]
+     * @param dMultiplier. Factor, by which the delay grows after every failed retry
+     * @param iMaxDelay. Maximal delay in [ms]
+     */
+    RetryPolicy(int iMaxAttempts = 1, int iInitialDelay = 0, double dMultiplier = 2.0,
+                int iMaxDelay = 10000) :
+        m_iMaxAttempts(iMaxAttempts),
+        m_iInitialDelay(iInitialDelay),
+        m_dMultiplier(dMultiplier),
+        m_iMaxDelay(iMaxDelay)
+    {   }
+
+    /**
+     * @brief shouldRetry. Checks, if the job should be processed again
+     * @param iAttempts. Number of attempts made so far
+     * @param iErr. Error code of the last attempt
+     * @return true, if the job should be processed again and false otherwise
+     */
+    bool shouldRetry(int iAttempts, int iErr) const
+    {
+        if (iAttempts >= m_iMaxAttempts) {
+            return false;
+        }
+        return (!m_fnRetryOn) || (m_fnRetryOn(iErr) == true);
+    }
+
+    /**
+     * @brief delay. Returns the delay before the next attempt
+     * @param iAttempts. Number of attempts made so far
+     * @return delay in [ms]
+     */
+    int delay(int iAttempts) const
+    {
+        double dDelay = m_iInitialDelay;
+        for (int i = 1; (i < iAttempts) && (dDelay < m_iMaxDelay); ++i) {
+            dDelay *= m_dMultiplier;
+        }
+        return static_cast<int>(qMin(dDelay, static_cast<double>(m_iMaxDelay)));
+    }
+
+    /**
+     * @brief m_iMaxAttempts. Maximal number of attempts, including the first one
+     */
+    int m_iMaxAttempts;
+    /**
+     * @brief m_iInitialDelay. Delay before the first retry in [ms]
+     */
+    int m_iInitialDelay;
+    /**
+     * @brief m_dMultiplier. Factor, by which the delay grows after every failed retry
+     */
+    double m_dMultiplier;
+    /**
+     * @brief m_iMaxDelay. Maximal delay between two attempts in [ms]
+     */
+    int m_iMaxDelay;
+    /**
+     * @brief m_fnRetryOn. Predicate, which returns true for error codes, which
+     * should be retried. If it is empty, all the errors are retried
+     */
+    std::function<bool(int)> m_fnRetryOn;
+};
+
+}   // namespace
+
+#endif // RETRYPOLICY_H
@@ -0,0 +1,170 @@
+#include <QDebug>
+
+#include "schedulingpolicies.h"
+#include "abstractjob.h"
+
+namespace thr {
+
+//-----------------------------------------------------------------------------
+
+/**
+ * @brief selectHighest. Selects the ready job with the highest key. The readiness is
+ * only checked for the jobs, which could replace the current best one, since checking
+ * it is more expensive than computing the key
+ * @param queue. Queue of the waiting jobs
+ * @param fnKey. Function returning the key for the given position in the queue
+ * @return position of the selected job or -1, if no job is ready
+ */
+template <typename F>
+static int selectHighest(const SchedulingQueue& queue, F fnKey)
+{
+    int iBest = -1;
+    double dBest = 0.0;
+    for (int i = 0; i < queue.count(); ++i) {
+        double dKey = fnKey(i);
+        if ((iBest >= 0) && (dKey <= dBest)) {
+            continue;
+        }
+        if (queue.isReady(i) == true) {
+            iBest = i;
+            dBest = dKey;
+        }
+    }
+    return iBest;
+}
+
+//-----------------------------------------------------------------------------
+
+FifoPolicy::FifoPolicy() : AbstractSchedulingPolicy()
+{
+    m_iNext = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+int FifoPolicy::selectJob(const SchedulingQueue& queue)
+{
+    int iN = queue.count();
+    if (m_iNext >= iN) {
+        m_iNext = 0;
+    }
+    // the jobs before m_iNext were not ready, when the search passed them last time
+    for (int i = 0; i < iN; ++i) {
+        int iPos = (m_iNext + i) % iN;
+        if (queue.isReady(iPos) == true) {
+            // the selected job is taken out of the queue, so its successor moves here
+            m_iNext = iPos;
+            return iPos;
+        }
+    }
+    return -1;
+}
+
+//-----------------------------------------------------------------------------
+
+void FifoPolicy::reset()
+{
+    m_iNext = 0;
+}
+
+//-----------------------------------------------------------------------------
+
+int LifoPolicy::selectJob(const SchedulingQueue& queue)
+{
+    for (int i = queue.count() - 1; i >= 0; --i) {
+        if (queue.isReady(i) == true) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+//-----------------------------------------------------------------------------
+
+int PriorityPolicy::selectJob(const SchedulingQueue& queue)
+{
+    return selectHighest(queue, [&queue](int i) { return static_cast<double>(queue.job(i)->priority()); });
+}
+
+//-----------------------------------------------------------------------------
+
+int CriticalPathPolicy::selectJob(const SchedulingQueue& queue)
+{
+    return selectHighest(queue, [&queue](int i) { return queue.rank(i); });
+}
+
+//-----------------------------------------------------------------------------
+
+bool CriticalPathPolicy::needsRanks() const
+{
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+int LongestFirstPolicy::selectJob(const SchedulingQueue& queue)
+{
+    return selectHighest(queue, [&queue](int i) { return queue.cost(i); });
+}
+
+//-----------------------------------------------------------------------------
+
+bool LongestFirstPolicy::needsCosts() const
+{
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+int LocalityPolicy::selectJob(const SchedulingQueue& queue)
+{
+    QVector<int> vIdle = queue.idleThreads();
+    int iFirst = -1;
+    for (int i = 0; i < queue.count(); ++i) {
+        int iThr = preferredThread(queue.job(i));
+        if ((iFirst >= 0) && ((iThr < 0) || (vIdle.contains(iThr) == false))) {
+            continue;
+        }
+        if (queue.isReady(i) == true) {
+            if ((iThr >= 0) && (vIdle.contains(iThr) == true)) {
+                return i;
+            }
+            iFirst = i;
+        }
+    }
+    return iFirst;
+}
+
+//-----------------------------------------------------------------------------
+
+int LocalityPolicy::selectThread(const AbstractJob* pJob, const QVector<int>& vIdle)
+{
+    int iPos = qMax(0, vIdle.indexOf(preferredThread(pJob)));
+    if (pJob->affinityKey() >= 0) {
+        m_hashKeyThread.insert(pJob->affinityKey(), vIdle[iPos]);
+    }
+    return iPos;
+}
+
+//-----------------------------------------------------------------------------
+
+int LocalityPolicy::preferredThread(const AbstractJob* pJob) const
+{
+    if ((pJob->affinityJob().isNull() == false) && (pJob->affinityJob()->worker() >= 0)) {
+        return pJob->affinityJob()->worker();
+    }
+    if ((pJob->affinityKey() >= 0) && (m_hashKeyThread.contains(pJob->affinityKey()) == true)) {
+        return m_hashKeyThread.value(pJob->affinityKey());
+    }
+    const QVector<JobPointer>& rvspDep = pJob->dependencies();
+    for (int i = rvspDep.count() - 1; i >= 0; --i) {
+        if (rvspDep[i]->worker() >= 0) {
+            return rvspDep[i]->worker();
+        }
+    }
+    return -1;
+}
+
+//-----------------------------------------------------------------------------
+
+}   // namespace
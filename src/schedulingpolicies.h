@@ -0,0 +1,186 @@
+#ifndef SCHEDULINGPOLICIES_H
+#define SCHEDULINGPOLICIES_H
+
+/************************************************************************************
+ *                                                                                  *
+ *  Project:     ThreadingLib                                                       *
+ *  File:        schedulingpolicies.h                                               *
+ *  Class:       FifoPolicy, LifoPolicy, PriorityPolicy, CriticalPathPolicy,        *
+ *               LongestFirstPolicy, LocalityPolicy                                 *
+ *  Author:      Bojan Kverh                                                        *
+ *  License:     LGPL                                                               *
+ *                                                                                  *
+ ************************************************************************************/
+
+#include <QHash>
+
+#include "abstractschedulingpolicy.h"
+
+namespace thr {
+
+/**
+ * @brief The FifoPolicy class. This policy starts the ready jobs in the order they
+ * were queued. It is the default policy of the JobManager. <br/><br/>
+ * The search for a ready job continues after the job selected last, so the jobs
+ * waiting for their dependencies at the head of the queue are not checked again
+ * every time; they are checked once per pass through the queue.
+ */
+class FifoPolicy : public AbstractSchedulingPolicy
+{
+public:
+    /**
+     * @brief FifoPolicy. Constructor
+     */
+    FifoPolicy();
+
+    /**
+     * @brief selectJob. Selects the first ready job in the queue, starting the search
+     * after the job selected last
+     * @param queue. Queue of the waiting jobs
+     * @return position of the selected job or -1, if no job is ready
+     */
+    int selectJob(const SchedulingQueue& queue);
+    /**
+     * @brief reset. Starts the search at the head of the queue again
+     */
+    void reset();
+
+private:
+    /**
+     * @brief m_iNext. Position in the queue, where the search starts: the position
+     * of the job following the one selected last
+     */
+    int m_iNext;
+};
+
+/**
+ * @brief The LifoPolicy class. This policy starts the most recently queued ready job
+ * first. When jobs spawn other jobs, this processes the spawned jobs depth first, which
+ * keeps the number of waiting jobs and the memory they hold small.
+ */
+class LifoPolicy : public AbstractSchedulingPolicy
+{
+public:
+    /**
+     * @brief selectJob. Selects the last ready job in the queue
+     * @param queue. Queue of the waiting jobs
+     * @return position of the selected job or -1, if no job is ready
+     */
+    int selectJob(const SchedulingQueue& queue);
+};
+
+/**
+ * @brief The PriorityPolicy class. This policy starts the ready job with the highest
+ * priority (see AbstractJob::setPriority()) first. Jobs with equal priority are started
+ * in the order they were queued.
+ */
+class PriorityPolicy : public AbstractSchedulingPolicy
+{
+public:
+    /**
+     * @brief selectJob. Selects the ready job with the highest priority
+     * @param queue. Queue of the waiting jobs
+     * @return position of the selected job or -1, if no job is ready
+     */
+    int selectJob(const SchedulingQueue& queue);
+};
+
+/**
+ * @brief The CriticalPathPolicy class. This policy starts the ready job with the highest
+ * upward rank first, that is the job on the longest remaining path through the
+ * dependency graph (see JobManager::rank()). Jobs with equal rank are started in the
+ * order they were queued.
+ */
+class CriticalPathPolicy : public AbstractSchedulingPolicy
+{
+public:
+    /**
+     * @brief selectJob. Selects the ready job with the highest upward rank
+     * @param queue. Queue of the waiting jobs
+     * @return position of the selected job or -1, if no job is ready
+     */
+    int selectJob(const SchedulingQueue& queue);
+    /**
+     * @brief needsRanks. Returns true, since the ranks are used
+     * @return true
+     */
+    bool needsRanks() const;
+};
+
+/**
+ * @brief The LongestFirstPolicy class. This policy starts the ready job with the largest
+ * estimated processing time (see AbstractJob::setCost()) first, so a long job queued
+ * last does not extend the total processing time. Jobs with equal cost are started in
+ * the order they were queued.
+ */
+class LongestFirstPolicy : public AbstractSchedulingPolicy
+{
+public:
+    /**
+     * @brief selectJob. Selects the ready job with the largest estimated processing time
+     * @param queue. Queue of the waiting jobs
+     * @return position of the selected job or -1, if no job is ready
+     */
+    int selectJob(const SchedulingQueue& queue);
+    /**
+     * @brief needsCosts. Returns true, since the costs are used
+     * @return true
+     */
+    bool needsCosts() const;
+};
+
+/**
+ * @brief The LocalityPolicy class. This policy prefers to process a job in the thread,
+ * which processed related jobs before: the same worker thread, which likely still has
+ * the data they share in its cache. The threads are not pinned to processor cores, so
+ * this is a preference, not a guarantee.
+ *
+ * @details The preferred thread of a job is, in this order:
+ * - the thread, which processed its affinity job (see AbstractJob::setAffinityJob())
+ * - the thread, which processed the last job with the same affinity key (see
+ *   AbstractJob::setAffinityKey())
+ * - the thread, which processed the most recently added of its dependencies
+ *
+ * The first ready job in the queue, whose preferred thread is idle, is started in
+ * that thread. If there is no such job, the first ready job is started in the thread,
+ * which has been idle the longest, so no thread is left idle while there is work to
+ * do, even if it has to take over the work of a busy thread.
+ */
+class LocalityPolicy : public AbstractSchedulingPolicy
+{
+public:
+    /**
+     * @brief selectJob. Selects the first ready job, whose preferred thread is idle,
+     * or the first ready job, if there is no such job
+     * @param queue. Queue of the waiting jobs
+     * @return position of the selected job or -1, if no job is ready
+     */
+    int selectJob(const SchedulingQueue& queue);
+    /**
+     * @brief selectThread. Selects the preferred thread of the job, if it is idle, or
+     * the thread, which has been idle the longest, otherwise
+     * @param pJob. Pointer to the selected job
+     * @param vIdle. Slot indices of the idle threads
+     * @return position of the selected thread in vIdle
+     */
+    int selectThread(const AbstractJob* pJob, const QVector<int>& vIdle);
+
+private:
+    /**
+     * @brief preferredThread. Returns the slot index of the preferred thread of the job
+     * @param pJob. Pointer to the job
+     * @return slot index of the preferred thread or -1, if the job has no preference
+     */
+    int preferredThread(const AbstractJob* pJob) const;
+
+private:
+    /**
+     * @brief m_hashKeyThread. Slot index of the thread, which processed the last job
+     * with the given affinity key
+     */
+    QHash<int, int> m_hashKeyThread;
+};
+
+}   // namespace
+
+#endif // SCHEDULINGPOLICIES_H
@@ -0,0 +1,191 @@
+#ifndef SUBMISSIONQUEUE_H
+#define SUBMISSIONQUEUE_H
+
+/************************************************************************************
+ *                                                                                  *
+ *  Project:     ThreadingLib                                                       *
+ *  File:        submissionqueue.h                                                  *
+ *  Class:       SubmissionQueue                                                    *
+ *  Author:      Bojan Kverh                                                        *
+ *  License:     LGPL                                                               *
+ *                                                                                  *
+ ************************************************************************************/
+
+#include <QAtomicPointer>
+#include <QAtomicInt>
+#include <QVector>
+
+namespace thr {
+
+/**
+ * @brief The SubmissionQueue class. This is a lock-free queue with many producers
+ * and a single consumer, which is used to hand over newly submitted items to the
+ * thread, which owns the consumer side.
+ *
+ * @details Any number of threads can call push() at the same time without ever
+ * blocking each other. Pushed items are kept in an intrusive stack, so publishing
+ * an item costs a single atomic compare-and-swap. The consumer takes all the pushed
+ * items at once with takeAll(), which costs a single atomic exchange, and receives
+ * them in the order they were pushed. <br/><br/>
+ * A whole batch of items can be pushed with a single atomic operation as well. <br/><br/>
+ * Only one thread at a time is allowed to call takeAll(). push() returns true, if
+ * the queue was empty before the push, so the producer can notify the consumer only
+ * once per batch of items instead of once per item.
+ */
+template <typename T>
+class SubmissionQueue
+{
+    /**
+     * @brief The Node struct. This structure holds one pushed item
+     */
+    struct Node
+    {
+        Node(const T& value) : m_value(value), m_pNext(nullptr)
+        {   }
+
+        /**
+         * @brief m_value. Pushed item
+         */
+        T m_value;
+        /**
+         * @brief m_pNext. Pointer to the item pushed before this one
+         */
+        Node* m_pNext;
+    };
+
+public:
+    /**
+     * @brief SubmissionQueue. Default constructor
+     */
+    SubmissionQueue() : m_pHead(nullptr), m_iCount(0)
+    {   }
+    /**
+     * @brief ~SubmissionQueue. Destructor. Deletes all the nodes, which were not
+     * taken yet, but not the items themselves
+     */
+    ~SubmissionQueue()
+    {
+        Node* pNode = m_pHead.fetchAndStoreAcquire(nullptr);
+        while (pNode != nullptr) {
+            Node* pNext = pNode->m_pNext;
+            delete pNode;
+            pNode = pNext;
+        }
+    }
+
+    /**
+     * @brief push. Pushes the item into the queue. This method is thread safe and
+     * never blocks.
+     * @param value. Item to push
+     * @return true, if the queue was empty before this item was pushed and false
+     * otherwise
+     */
+    bool push(const T& value)
+    {
+        Node* pNode = new Node(value);
+        m_iCount.fetchAndAddRelaxed(1);
+        return publish(pNode, pNode);
+    }
+
+    /**
+     * @brief push. Pushes all the items from the vector into the queue with a single
+     * atomic operation. This method is thread safe and never blocks.
+     * @param vValues. Items to push
+     * @return true, if the queue was empty before the items were pushed and false
+     * otherwise
+     */
+    bool push(const QVector<T>& vValues)
+    {
+        if (vValues.isEmpty() == true) {
+            return false;
+        }
+
+        // link the nodes privately first, so the whole chain is published at once
+        Node* pFirst = new Node(vValues.first());
+        Node* pLast = pFirst;
+        for (int i = 1; i < vValues.count(); ++i) {
+            Node* pNode = new Node(vValues[i]);
+            pNode->m_pNext = pLast;
+            pLast = pNode;
+        }
+        m_iCount.fetchAndAddRelaxed(vValues.count());
+        return publish(pLast, pFirst);
+    }
+
+    /**
+     * @brief takeAll. Takes all the items from the queue and appends them to
+     * the given vector in the order they were pushed. Only one thread at a time
+     * is allowed to call this method.
+     * @param rvValues. Vector, where the items will be appended
+     * @return number of items taken
+     */
+    int takeAll(QVector<T>& rvValues)
+    {
+        Node* pNode = m_pHead.fetchAndStoreAcquire(nullptr);
+        // the stack holds the most recent item first, so reverse it
+        Node* pReversed = nullptr;
+        while (pNode != nullptr) {
+            Node* pNext = pNode->m_pNext;
+            pNode->m_pNext = pReversed;
+            pReversed = pNode;
+            pNode = pNext;
+        }
+
+        int iCnt = 0;
+        while (pReversed != nullptr) {
+            Node* pNext = pReversed->m_pNext;
+            rvValues.append(pReversed->m_value);
+            delete pReversed;
+            pReversed = pNext;
+            ++iCnt;
+        }
+        m_iCount.fetchAndAddRelaxed(-iCnt);
+        return iCnt;
+    }
+
+    /**
+     * @brief isEmpty. Returns true, if there are no items in the queue
+     * @return true, if there are no items in the queue at the moment and false
+     * otherwise
+     */
+    bool isEmpty() const
+    {   return m_pHead.loadAcquire() == nullptr; }
+    /**
+     * @brief count. Returns the approximate number of items in the queue
+     * @return approximate number of items in the queue
+     */
+    int count() const
+    {   return qMax(0, m_iCount.loadAcquire()); }
+
+private:
+    /**
+     * @brief publish. Publishes the chain of nodes, linked from pFirst to pLast
+     * @param pFirst. Pointer to the most recently pushed node of the chain
+     * @param pLast. Pointer to the oldest node of the chain
+     * @return true, if the queue was empty before the chain was published
+     */
+    bool publish(Node* pFirst, Node* pLast)
+    {
+        Node* pHead = m_pHead.loadAcquire();
+        do {
+            pLast->m_pNext = pHead;
+        }   while (m_pHead.testAndSetRelease(pHead, pFirst, pHead) == false);
+        return pHead == nullptr;
+    }
+
+    Q_DISABLE_COPY(SubmissionQueue)
+
+private:
+    /**
+     * @brief m_pHead. Pointer to the most recently pushed node
+     */
+    QAtomicPointer<Node> m_pHead;
+    /**
+     * @brief m_iCount. Approximate number of items in the queue
+     */
+    QAtomicInt m_iCount;
+};
+
+}   // namespace
+
+#endif // SUBMISSIONQUEUE_H
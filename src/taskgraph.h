@@ -0,0 +1,447 @@
+#ifndef TASKGRAPH_H
+#define TASKGRAPH_H
+
+/************************************************************************************
+ *                                                                                  *
+ *  Project:     ThreadingLib                                                       *
+ *  File:        taskgraph.h                                                        *
+ *  Class:       TaskGraph, TaskGraphChunk                                          *
+ *  Author:      Bojan Kverh                                                        *
+ *  License:     LGPL                                                               *
+ *                                                                                  *
+ ************************************************************************************/
+
+#include <tuple>
+#include <utility>
+
+#include <QSharedPointer>
+#include <QVector>
+
+#include "jobmanager.h"
+
+namespace thr {
+
+/**
+ * @brief The TaskEdge struct. Compile time edge of a TaskGraph: task iTo can only be
+ * processed after task iFrom is processed
+ */
+template <int iFrom, int iTo>
+struct TaskEdge
+{
+    static const int from = iFrom;
+    static const int to = iTo;
+};
+
+/**
+ * @brief taskMax. Returns the larger of the two numbers at compile time
+ */
+constexpr int taskMax(int iA, int iB)
+{
+    return (iA > iB)? iA : iB;
+}
+
+/**
+ * @brief The TaskIndices struct. Compile time list of task indices
+ */
+template <int... Is>
+struct TaskIndices
+{   };
+
+template <int N, int... Is>
+struct MakeTaskIndices : MakeTaskIndices<N - 1, N - 1, Is...>
+{   };
+
+template <int... Is>
+struct MakeTaskIndices<0, Is...>
+{
+    typedef TaskIndices<Is...> Type;
+};
+
+/**
+ * @brief The TaskLevels struct. Compile time list of the levels of the tasks. A task,
+ * which is not sorted yet, has level -1
+ */
+template <int... Ls>
+struct TaskLevels
+{
+    static constexpr int s_aiLevel[] = { Ls..., 0 };
+
+    static constexpr int count()
+    {   return sizeof...(Ls); }
+    static constexpr int at(int iTask)
+    {   return ((iTask >= 0) && (iTask < count()))? s_aiLevel[iTask] : 0; }
+};
+
+template <int... Ls>
+constexpr int TaskLevels<Ls...>::s_aiLevel[];
+
+template <typename Indices>
+struct TaskUnsorted;
+
+template <int... Is>
+struct TaskUnsorted<TaskIndices<Is...>>
+{
+    typedef TaskLevels<(0*Is - 1)...> Type;
+};
+
+template <typename Levels, int iTask, int iLevel,
+          typename Indices = typename MakeTaskIndices<Levels::count()>::Type>
+struct TaskLevelsSet;
+
+template <int... Ls, int iTask, int iLevel, int... Is>
+struct TaskLevelsSet<TaskLevels<Ls...>, iTask, iLevel, TaskIndices<Is...>>
+{
+    typedef TaskLevels<((Is == iTask)? iLevel : Ls)...> Type;
+};
+
+/**
+ * @brief The TaskKahnStep struct. One step of the topological sort of the tasks: finds
+ * an unsorted task, whose predecessors are all sorted, and its level. The ranges of
+ * edges and tasks are halved, so the recursion depth only grows with the logarithm
+ * of the size of the graph
+ */
+template <typename Edges, typename Levels>
+struct TaskKahnStep
+{
+    static constexpr bool isSortedFrom(int iTask, int iFirst, int iLast)
+    {
+        return (iFirst >= iLast) || ((iLast - iFirst == 1)?
+                    ((Edges::s_aiTo[iFirst] != iTask) || (Levels::at(Edges::s_aiFrom[iFirst]) >= 0)) :
+                    (isSortedFrom(iTask, iFirst, (iFirst + iLast)/2) &&
+                     isSortedFrom(iTask, (iFirst + iLast)/2, iLast)));
+    }
+    static constexpr int levelFrom(int iTask, int iFirst, int iLast)
+    {
+        return (iFirst >= iLast)? 0 : ((iLast - iFirst == 1)?
+                    ((Edges::s_aiTo[iFirst] == iTask)? Levels::at(Edges::s_aiFrom[iFirst]) + 1 : 0) :
+                    taskMax(levelFrom(iTask, iFirst, (iFirst + iLast)/2),
+                            levelFrom(iTask, (iFirst + iLast)/2, iLast)));
+    }
+    static constexpr bool isReady(int iTask)
+    {   return (Levels::at(iTask) < 0) && isSortedFrom(iTask, 0, Edges::edgeCount()); }
+    static constexpr int findReady(int iFirst, int iLast)
+    {
+        return (iFirst >= iLast)? -1 : ((iLast - iFirst == 1)?
+                    (isReady(iFirst)? iFirst : -1) :
+                    orFind(findReady(iFirst, (iFirst + iLast)/2), (iFirst + iLast)/2, iLast));
+    }
+    static constexpr int orFind(int iFound, int iFirst, int iLast)
+    {   return (iFound >= 0)? iFound : findReady(iFirst, iLast); }
+
+    /**
+     * @brief next. Returns the next task in topological order
+     * @return index of the task or -1, if all the tasks are sorted or the remaining
+     * ones are on a cycle
+     */
+    static constexpr int next()
+    {   return findReady(0, Levels::count()); }
+    /**
+     * @brief level. Returns the level of the task: one more than the largest level
+     * of its predecessors
+     * @param iTask. Index of the task or -1
+     * @return level of the task or -1, if iTask is -1
+     */
+    static constexpr int level(int iTask)
+    {   return (iTask < 0)? -1 : levelFrom(iTask, 0, Edges::edgeCount()); }
+};
+
+/**
+ * @brief The TaskSort struct. Kahn's topological sort of the tasks at compile time:
+ * every step sorts one task, so the level of every task is computed once. The tasks
+ * left with level -1 are on a cycle
+ */
+template <typename Edges, typename Levels, int iSteps>
+struct TaskSort
+{
+    typedef TaskKahnStep<Edges, Levels> Step;
+    static const int s_iNext = Step::next();
+    typedef typename TaskSort<
+            Edges, typename TaskLevelsSet<Levels, s_iNext, Step::level(s_iNext)>::Type,
+            iSteps - 1>::Type Type;
+};
+
+template <typename Edges, typename Levels>
+struct TaskSort<Edges, Levels, 0>
+{
+    typedef Levels Type;
+};
+
+/**
+ * @brief The TaskEdges struct. Compile time list of the edges of a TaskGraph
+ */
+template <typename... Es>
+struct TaskEdges
+{
+    static constexpr int s_aiFrom[] = { Es::from..., -1 };
+    static constexpr int s_aiTo[] = { Es::to..., -1 };
+
+    /**
+     * @brief edgeCount. Returns the number of edges
+     * @return number of edges
+     */
+    static constexpr int edgeCount()
+    {   return sizeof...(Es); }
+    /**
+     * @brief taskBound. Returns the number of tasks named by the edges: one more than
+     * the largest task index
+     * @return number of tasks named by the edges
+     */
+    static constexpr int taskBound()
+    {   return maxTask(0, edgeCount()) + 1; }
+    /**
+     * @brief level. Returns the level of the task: the length of the longest path of
+     * edges leading into it. Tasks on the same level do not depend on each other
+     * @param iTask. Index of the task
+     * @return level of the task or -1, if the task is on a cycle
+     */
+    static constexpr int level(int iTask)
+    {
+        return (isValid(taskBound()) == false)? -1 :
+                TaskSort<TaskEdges, typename TaskUnsorted<typename MakeTaskIndices<taskBound()>::Type>::Type,
+                         taskBound()>::Type::at(iTask);
+    }
+    /**
+     * @brief isValid. Checks, if all the edges connect two different existing tasks
+     * @param iTasks. Number of tasks
+     * @return true, if all the edges are valid
+     */
+    static constexpr bool isValid(int iTasks)
+    {   return areValid(0, edgeCount(), iTasks); }
+
+private:
+    static constexpr int maxTask(int iFirst, int iLast)
+    {
+        return (iFirst >= iLast)? -1 : ((iLast - iFirst == 1)?
+                    taskMax(s_aiFrom[iFirst], s_aiTo[iFirst]) :
+                    taskMax(maxTask(iFirst, (iFirst + iLast)/2), maxTask((iFirst + iLast)/2, iLast)));
+    }
+    static constexpr bool areValid(int iFirst, int iLast, int iTasks)
+    {
+        return (iFirst >= iLast) || ((iLast - iFirst == 1)?
+                    ((s_aiFrom[iFirst] >= 0) && (s_aiFrom[iFirst] < iTasks) &&
+                     (s_aiTo[iFirst] >= 0) && (s_aiTo[iFirst] < iTasks) &&
+                     (s_aiFrom[iFirst] != s_aiTo[iFirst])) :
+                    (areValid(iFirst, (iFirst + iLast)/2, iTasks) &&
+                     areValid((iFirst + iLast)/2, iLast, iTasks)));
+    }
+};
+
+template <typename... Es>
+constexpr int TaskEdges<Es...>::s_aiFrom[];
+
+template <typename... Es>
+constexpr int TaskEdges<Es...>::s_aiTo[];
+
+/**
+ * @brief The TaskGraphChunk class. This job processes a contiguous part of the
+ * execution plan of a TaskGraph. The tasks are called through plain function
+ * pointers, so only the chunk itself is dispatched virtually.
+ */
+class TaskGraphChunk : public AbstractJob
+{
+public:
+    /**
+     * @brief Task. Function processing one task of the graph
+     */
+    typedef void (*Task)(void* pGraph);
+
+    /**
+     * @brief TaskGraphChunk. Constructor
+     * @param pGraph. Pointer to the graph holding the tasks
+     * @param pTasks. Pointer to the first task of the chunk
+     * @param iCount. Number of tasks in the chunk
+     */
+    TaskGraphChunk(void* pGraph, const Task* pTasks, int iCount) : AbstractJob()
+    {
+        m_pGraph = pGraph;
+        m_pTasks = pTasks;
+        m_iCount = iCount;
+    }
+
+protected:
+    void process()
+    {
+        for (int i = 0; i < m_iCount; ++i) {
+            CHECK_JOB_PAUSE();
+            m_pTasks[i](m_pGraph);
+        }
+    }
+
+private:
+    void* m_pGraph;
+    const Task* m_pTasks;
+    int m_iCount;
+};
+
+/**
+ * @brief The TaskGraph class. This class processes a graph of tasks with a shape known
+ * at compile time.
+ *
+ * @details The tasks are callable objects without parameters, e.g. lambdas, stored by
+ * value. The edges are given as a TaskEdges list of TaskEdge types, so the levels of
+ * the tasks are computed by the compiler and an invalid or cyclic graph does not
+ * compile. The graph is turned into a flat execution plan: the tasks sorted by their
+ * level. appendTo() appends a few TaskGraphChunk jobs per level to the JobManager,
+ * each processing a part of the level, and makes every chunk depend on the chunks of
+ * the previous level. The tasks themselves are not jobs: there is no QObject, no
+ * virtual call and no dependency checking per task, so a task costs little more
+ * than a function call. <br/><br/>
+ * Use it for many small tasks with a fixed shape; use jobs, when the tasks are long,
+ * need their own dependencies, errors, retries or timeouts, or when the shape is only
+ * known at run time. <br/><br/>
+ * Example:
+ * @code
+    int iA = 0, iB = 0, iC = 0;
+    // task 0 feeds tasks 1 and 2
+    auto spGraph = thr::makeTaskGraph<thr::TaskEdges<thr::TaskEdge<0, 1>, thr::TaskEdge<0, 2>>>(
+                [&iA]() { iA = 1; },
+                [&iA, &iB]() { iB = iA + 1; },
+                [&iA, &iC]() { iC = iA + 2; });
+    thr::JobManager jm;
+    spGraph->appendTo(jm);
+    jm.start();
+    jm.wait();
+ * @endcode
+ * The appended jobs refer to the graph, so it cannot be copied or moved; makeTaskGraph()
+ * creates it on the heap. The graph has to exist until the appended jobs are processed.
+ */
+template <typename Edges, typename... Fns>
+class TaskGraph
+{
+public:
+    static_assert(Edges::isValid(sizeof...(Fns)), "TaskGraph: an edge refers to a missing task or to itself");
+
+    /**
+     * @brief TaskGraph. Constructor
+     * @param fns. Callable objects processing the tasks; the index of a task is its
+     * position in this list
+     */
+    explicit TaskGraph(Fns... fns) : m_tasks(std::move(fns)...)
+    {
+        static_assert(isAcyclic(0), "TaskGraph: the edges form a cycle");
+        buildPlan(typename MakeTaskIndices<sizeof...(Fns)>::Type());
+    }
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph(TaskGraph&&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+    TaskGraph& operator=(TaskGraph&&) = delete;
+
+    /**
+     * @brief taskCount. Returns the number of tasks
+     * @return number of tasks
+     */
+    static constexpr int taskCount()
+    {   return sizeof...(Fns); }
+    /**
+     * @brief level. Returns the level of the task (see TaskEdges::level())
+     * @param iTask. Index of the task
+     * @return level of the task
+     */
+    static constexpr int level(int iTask)
+    {   return Edges::level(iTask); }
+    /**
+     * @brief isAcyclic. Checks, if none of the tasks from iTask on is on a cycle
+     * @param iTask. Index of the first task to check
+     * @return true, if there is no cycle
+     */
+    static constexpr bool isAcyclic(int iTask)
+    {   return (iTask >= taskCount()) || ((level(iTask) >= 0) && isAcyclic(iTask + 1)); }
+    /**
+     * @brief levelCount. Returns the number of levels
+     * @return number of levels
+     */
+    int levelCount() const
+    {   return m_viLevelStart.count() - 1; }
+    /**
+     * @brief appendTo. Appends the jobs processing the graph to the job manager.
+     * The job manager has to be started afterwards
+     * @param rJM. Job manager
+     * @param iChunks. Maximal number of jobs per level. If it is 0 or negative, the
+     * number of threads of the job manager is used
+     */
+    void appendTo(JobManager& rJM, int iChunks = 0)
+    {
+        if (iChunks <= 0) {
+            iChunks = qMax(1, rJM.threadCount());
+        }
+        QVector<JobPointer> vspPrev;
+        for (int iLevel = 0; iLevel < levelCount(); ++iLevel) {
+            int iFirst = m_viLevelStart[iLevel];
+            int iN = m_viLevelStart[iLevel + 1] - iFirst;
+            int iParts = qMin(iChunks, iN);
+            QVector<JobPointer> vspCurrent;
+            for (int i = 0; i < iParts; ++i) {
+                int iBegin = iFirst + i*iN/iParts;
+                int iEnd = iFirst + (i + 1)*iN/iParts;
+                auto pChunk = new TaskGraphChunk(this, m_vpfnPlan.data() + iBegin, iEnd - iBegin);
+                JobPointer spChunk(pChunk);
+                for (int j = 0; j < vspPrev.count(); ++j) {
+                    pChunk->addDependency(vspPrev[j]);
+                }
+                rJM.appendJob(pChunk);
+                vspCurrent.append(spChunk);
+            }
+            vspPrev = vspCurrent;
+        }
+    }
+
+private:
+    /**
+     * @brief run. Processes task I of the graph
+     * @param pGraph. Pointer to the graph
+     */
+    template <int I>
+    static void run(void* pGraph)
+    {   std::get<I>(static_cast<TaskGraph*>(pGraph)->m_tasks)(); }
+
+    /**
+     * @brief buildPlan. Sorts the tasks by their level into the execution plan
+     */
+    template <int... Is>
+    void buildPlan(TaskIndices<Is...>)
+    {
+        const int aiLevel[] = { level(Is)..., 0 };
+        const TaskGraphChunk::Task apfnTask[] = { &TaskGraph::run<Is>..., nullptr };
+
+        for (int iLevel = 0; m_vpfnPlan.count() < taskCount(); ++iLevel) {
+            m_viLevelStart.append(m_vpfnPlan.count());
+            for (int i = 0; i < taskCount(); ++i) {
+                if (aiLevel[i] == iLevel) {
+                    m_vpfnPlan.append(apfnTask[i]);
+                }
+            }
+        }
+        m_viLevelStart.append(m_vpfnPlan.count());
+    }
+
+private:
+    /**
+     * @brief m_tasks. Callable objects processing the tasks
+     */
+    std::tuple<Fns...> m_tasks;
+    /**
+     * @brief m_vpfnPlan. Execution plan: the tasks sorted by their level
+     */
+    QVector<TaskGraphChunk::Task> m_vpfnPlan;
+    /**
+     * @brief m_viLevelStart. Position of the first task of every level in the plan,
+     * followed by the number of tasks
+     */
+    QVector<int> m_viLevelStart;
+};
+
+/**
+ * @brief makeTaskGraph. Creates a TaskGraph from the given callable objects, so their
+ * types do not have to be spelled out
+ * @param fns. Callable objects processing the tasks
+ * @return pointer to the task graph
+ */
+template <typename Edges, typename... Fns>
+QSharedPointer<TaskGraph<Edges, Fns...>> makeTaskGraph(Fns... fns)
+{
+    return QSharedPointer<TaskGraph<Edges, Fns...>>(new TaskGraph<Edges, Fns...>(std::move(fns)...));
+}
+
+}   // namespace
+
+#endif // TASKGRAPH_H
@@ -4,32 +4,130 @@
 
 namespace thr {
 
+/**
+ * @brief The IdleLimits struct. Spin and yield limits of an idle profile
+ */
+struct IdleLimits
+{
+    int m_iMaxSpin;         //!< maximal number of spins
+    int m_iYield;           //!< number of yields after spinning
+};
+
+static const IdleLimits s_aLimits[] = {
+    { 1 << 16, 256 },       // ipLowLatency
+    { 1 << 11, 16 },        // ipBalanced
+    { 0, 0 },               // ipPowerSaving
+};
+
 //-----------------------------------------------------------------------------
 
-Thread::Thread() : QThread()
+Thread::Thread(int iIndex, IdleProfile eProfile) : QThread()
 {
+    m_iIndex = iIndex;
     m_iJobIndex = -1;
-    m_spJob = 0;
+    m_iProfile.storeRelease(eProfile);
+    m_iPending.storeRelease(0);
+    m_iBusy.storeRelease(0);
+    m_iParked.storeRelease(0);
+    m_iQuit.storeRelease(0);
+    m_iSpin = s_aLimits[eProfile].m_iMaxSpin/4;
 }
 
 //-----------------------------------------------------------------------------
 
 Thread::~Thread()
-{   }
+{
+    m_iQuit.storeRelease(1);
+    wake();
+    QThread::wait();
+}
 
 //-----------------------------------------------------------------------------
 
-void Thread::start(int iJobIndex, QSharedPointer<AbstractJob> spJob)
+void Thread::start(int iJobIndex, JobPointer spJob)
 {
     m_iJobIndex = iJobIndex;
-    m_spJob = spJob;
-    if (m_spJob != 0) {
-        m_spJob->moveToThread(this);
-        connect(this, SIGNAL(started()), m_spJob.data(), SLOT(exec()));
-        connect(m_spJob.data(), SIGNAL(signalFinished()), this, SLOT(quit()));
-        connect(m_spJob.data(), SIGNAL(signalStopped()), this, SLOT(quit()));
-        connect(m_spJob.data(), SIGNAL(signalError()), this, SLOT(quit()));
-        QThread::start();
+    m_spJob = std::move(spJob);
+    if (m_spJob.isNull() == false) {
+        if (m_spJob->thread() == QThread::currentThread()) {
+            // a job can only be pushed away by the thread it belongs to
+            m_spJob->moveToThread(this);
+        }
+        m_timer.start();
+        m_iBusy.storeRelease(1);
+        m_iPending.fetchAndStoreOrdered(1);
+        if (QThread::isRunning() == false) {
+            QThread::start();
+        }   else {
+            wake();
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void Thread::run()
+{
+    while (waitForJob() == true) {
+        AbstractJob* pJob = m_spJob.data();
+        pJob->exec();
+        if ((m_fnJobDone) && (m_fnJobDone(this) == true)) {
+            // the next job was handed over already
+            continue;
+        }
+        m_iBusy.storeRelease(0);
+        emit signalJobDone();
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+bool Thread::waitForJob()
+{
+    const IdleLimits& rLimits = s_aLimits[idleProfile()];
+    m_iSpin = qBound(rLimits.m_iMaxSpin/16, m_iSpin, rLimits.m_iMaxSpin);
+
+    bool bArrived = false;
+    for (int i = 0; (i < m_iSpin) && (bArrived == false); ++i) {
+        bArrived = hasWork();
+    }
+    if (bArrived == true) {
+        // the job came while spinning, so spinning a bit longer may pay off next time
+        m_iSpin = qMin(2*m_iSpin + 1, rLimits.m_iMaxSpin);
+    }
+
+    for (int i = 0; (i < rLimits.m_iYield) && (bArrived == false); ++i) {
+        QThread::yieldCurrentThread();
+        bArrived = hasWork();
+    }
+
+    if (bArrived == false) {
+        QMutexLocker locker(&m_mutexPark);
+        // the full barrier pairs with the one in start(), so either this thread sees
+        // the pending job or start() sees this thread parked and wakes it up
+        m_iParked.fetchAndStoreOrdered(1);
+        while ((m_iPending.fetchAndAddOrdered(0) == 0) && (m_iQuit.loadAcquire() == 0)) {
+            m_condPark.wait(&m_mutexPark);
+        }
+        m_iParked.storeRelease(0);
+        // spinning did not help, so spin less next time
+        m_iSpin /= 2;
+    }
+
+    if (m_iQuit.loadAcquire() != 0) {
+        return false;
+    }
+    m_iPending.storeRelease(0);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+void Thread::wake()
+{
+    if ((m_iParked.fetchAndAddOrdered(0) != 0) || (m_iQuit.loadAcquire() != 0)) {
+        QMutexLocker locker(&m_mutexPark);
+        m_condPark.wakeOne();
     }
 }
 
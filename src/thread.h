@@ -1,16 +1,42 @@
 #ifndef THREAD_H
 #define THREAD_H
 
+#include <functional>
+
 #include <QThread>
-#include <QSharedPointer>
+#include <QElapsedTimer>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QWaitCondition>
 
 #include "abstractjob.h"
 
 namespace thr {
 
+/**
+ * @brief The IdleProfile enum. This enum describes, how an idle thread waits for
+ * its next job
+ */
+enum IdleProfile {
+    ipLowLatency,                   //!< spin long and yield often before sleeping; fastest start of the next job
+    ipBalanced,                     //!< spin briefly, then yield a few times, then sleep
+    ipPowerSaving,                  //!< sleep at once; no processor time is used while idle
+};
+
 /**
  * @brief The Thread class. This class is used to execute scheduled jobs. It
  * is used by JobManager for putting the job into a different thread
+ *
+ * @details The thread is started with its first job and keeps running until it is
+ * deleted, so no operating system thread is created per job. Between jobs, the
+ * thread first spins, checking for the next job, then it yields the processor a
+ * few times and finally it sleeps until JobManager wakes it up with the next job.
+ * How long it spins and yields depends on the idle profile. The spin length adapts:
+ * it grows when the next job arrives during the spinning and shrinks when the thread
+ * has to sleep anyway. <br/><br/>
+ * The signal signalJobDone() is emitted from the thread every time a job returns,
+ * unless the job done handler (see setJobDoneHandler()) took care of the job and
+ * handed the next one over at once.
  */
 class Thread : public QThread
 {
@@ -18,11 +44,15 @@ class Thread : public QThread
 
 public:
     /**
-     * @brief Thread. Default constructor
+     * @brief Thread. Constructor
+     * @param iIndex. Slot index of the thread in the JobManager. A thread, which
+     * replaces another thread, gets the same slot index
+     * @param eProfile. Idle profile of the thread
      */
-    Thread();
+    Thread(int iIndex = -1, IdleProfile eProfile = ipBalanced);
     /**
-     * @brief ~Thread. Destructor
+     * @brief ~Thread. Destructor. Waits until the current job returns and stops
+     * the thread
      */
     virtual ~Thread();
     /**
@@ -32,22 +62,141 @@ public:
     int jobIndex() const
     {   return m_iJobIndex; }
     /**
-     * @brief start. Starts processing given job
+     * @brief index. Returns the slot index of this thread in the JobManager
+     * @return slot index of this thread
+     */
+    int index() const
+    {   return m_iIndex; }
+    /**
+     * @brief start. Starts processing given job. The thread must not be busy, unless
+     * it is called from the job done handler. The job is moved to this thread, if it
+     * is called from the thread the job belongs to
      * @param iJobIndex. Index of job in the jobs vector
-     * @param spJob. Pointer to the job object to process. This object does not take
-     * ownership of the job!
+     * @param spJob. Pointer to the job object to process. This object holds a
+     * reference to the job until the next job is started.
      */
-    void start(int iJobIndex, QSharedPointer<AbstractJob> spJob);
+    void start(int iJobIndex, JobPointer spJob);
+    /**
+     * @brief setJobDoneHandler. Sets the function, which is called from this thread
+     * every time a job returns, before signalJobDone() is emitted. If the function
+     * returns true, it has taken care of the job and handed the next job over with
+     * start(), so the signal is not emitted and the thread goes on at once. It has to
+     * be set before the thread is started
+     * @param fnHandler. Job done handler
+     */
+    void setJobDoneHandler(std::function<bool (Thread*)> fnHandler)
+    {   m_fnJobDone = std::move(fnHandler); }
+    /**
+     * @brief isBusy. Returns true, if the thread is processing a job
+     * @return true, if the thread is processing a job and false otherwise
+     */
+    bool isBusy() const
+    {   return m_iBusy.loadAcquire() != 0; }
+    /**
+     * @brief elapsed. Returns the time since the current job was started
+     * @return time since the current job was started in [ms]
+     */
+    qint64 elapsed() const
+    {   return m_timer.elapsed(); }
+    /**
+     * @brief setIdleProfile. Sets the idle profile of this thread. It is used from the
+     * next time the thread becomes idle
+     * @param eProfile. New idle profile
+     */
+    void setIdleProfile(IdleProfile eProfile)
+    {   m_iProfile.storeRelease(eProfile); }
+    /**
+     * @brief idleProfile. Returns the idle profile of this thread
+     * @return idle profile
+     */
+    IdleProfile idleProfile() const
+    {   return static_cast<IdleProfile>(m_iProfile.loadAcquire()); }
+
+signals:
+    /**
+     * @brief signalJobDone. Emitted from the thread, when the current job returns
+     */
+    void signalJobDone();
+
+protected:
+    /**
+     * @brief run. Processes the jobs handed over by start() until the thread is
+     * deleted
+     */
+    void run();
 
 private:
+    /**
+     * @brief waitForJob. Waits until the next job is handed over or the thread
+     * is asked to quit
+     * @return true, if there is a job to process and false, if the thread should quit
+     */
+    bool waitForJob();
+    /**
+     * @brief hasWork. Checks, if a job was handed over or the thread was asked to quit
+     * @return true, if the thread should stop waiting
+     */
+    bool hasWork() const
+    {   return (m_iPending.loadAcquire() != 0) || (m_iQuit.loadAcquire() != 0); }
+    /**
+     * @brief wake. Wakes the thread up, if it is sleeping
+     */
+    void wake();
+
+private:
+    /**
+     * @brief m_iIndex. Slot index of this thread in the JobManager
+     */
+    int m_iIndex;
     /**
      * @brief m_iJobIndex. Index of the current job in the jobs vector
      */
     int m_iJobIndex;
     /**
-     * @brief m_spJob. Shared pointer to the processing job object
+     * @brief m_spJob. Pointer to the processing job object
+     */
+    JobPointer m_spJob;
+    /**
+     * @brief m_fnJobDone. Called from this thread, when a job returns
+     */
+    std::function<bool (Thread*)> m_fnJobDone;
+    /**
+     * @brief m_timer. Measures the processing time of the current job
+     */
+    QElapsedTimer m_timer;
+    /**
+     * @brief m_iProfile. Idle profile
+     */
+    QAtomicInt m_iProfile;
+    /**
+     * @brief m_iPending. Set to 1, when a job is handed over to the thread
+     */
+    QAtomicInt m_iPending;
+    /**
+     * @brief m_iBusy. Set to 1, while the thread is processing a job
+     */
+    QAtomicInt m_iBusy;
+    /**
+     * @brief m_iParked. Set to 1, while the thread is sleeping or about to sleep
+     */
+    QAtomicInt m_iParked;
+    /**
+     * @brief m_iQuit. Set to 1, when the thread should quit
+     */
+    QAtomicInt m_iQuit;
+    /**
+     * @brief m_iSpin. Current number of spins before yielding. It is only used by the
+     * thread itself
+     */
+    int m_iSpin;
+    /**
+     * @brief m_mutexPark. Synchronization object for sleeping
+     */
+    QMutex m_mutexPark;
+    /**
+     * @brief m_condPark. The thread sleeps on this condition
      */
-    QSharedPointer<AbstractJob> m_spJob;
+    QWaitCondition m_condPark;
 };
 
 }   // namespace
@@ -0,0 +1,85 @@
+#include <QDebug>
+
+#include "timerwheel.h"
+
+namespace thr {
+
+//-----------------------------------------------------------------------------
+
+TimerWheel::TimerWheel(int iTick, int iSlots, QObject* pParent) : QObject(pParent)
+{
+    m_iTick = qMax(1, iTick);
+    m_vvSlots.resize(qMax(1, iSlots));
+    m_iCursor = 0;
+    m_iCount = 0;
+    m_iTicked = 0;
+    m_timer.setInterval(m_iTick);
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(advance()));
+}
+
+//-----------------------------------------------------------------------------
+
+void TimerWheel::schedule(int iDelay, int iId)
+{
+    if (m_timer.isActive() == false) {
+        m_elapsed.start();
+        m_iTicked = 0;
+        m_timer.start();
+    }
+
+    // ticks are counted from the current position of the wheel
+    int iTicks = qMax(1, (iDelay + m_iTick - 1)/m_iTick);
+    int iSlots = m_vvSlots.count();
+    Entry entry;
+    entry.m_iId = iId;
+    entry.m_iRounds = (iTicks - 1)/iSlots;
+    m_vvSlots[(m_iCursor + iTicks) % iSlots].append(entry);
+    ++m_iCount;
+}
+
+//-----------------------------------------------------------------------------
+
+void TimerWheel::clear()
+{
+    for (int i = 0; i < m_vvSlots.count(); ++i) {
+        m_vvSlots[i].clear();
+    }
+    m_iCount = 0;
+    m_timer.stop();
+}
+
+//-----------------------------------------------------------------------------
+
+void TimerWheel::advance()
+{
+    QVector<int> vExpired;
+    qint64 iTarget = m_elapsed.elapsed()/m_iTick;
+    while ((m_iTicked < iTarget) && (m_iCount > vExpired.count())) {
+        ++m_iTicked;
+        m_iCursor = (m_iCursor + 1) % m_vvSlots.count();
+        QVector<Entry>& rvSlot = m_vvSlots[m_iCursor];
+        int iKept = 0;
+        for (int i = 0; i < rvSlot.count(); ++i) {
+            if (rvSlot[i].m_iRounds == 0) {
+                vExpired.append(rvSlot[i].m_iId);
+            }   else {
+                --rvSlot[i].m_iRounds;
+                rvSlot[iKept++] = rvSlot[i];
+            }
+        }
+        rvSlot.resize(iKept);
+    }
+    m_iCount -= vExpired.count();
+    if (m_iCount == 0) {
+        m_timer.stop();
+    }
+
+    // the events are reported after the wheel is consistent, so they can be rescheduled
+    for (int i = 0; i < vExpired.count(); ++i) {
+        emit signalExpired(vExpired[i]);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+}   // namespace
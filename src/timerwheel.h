@@ -0,0 +1,126 @@
+#ifndef TIMERWHEEL_H
+#define TIMERWHEEL_H
+
+/************************************************************************************
+ *                                                                                  *
+ *  Project:     ThreadingLib                                                       *
+ *  File:        timerwheel.h                                                       *
+ *  Class:       TimerWheel                                                         *
+ *  Author:      Bojan Kverh                                                        *
+ *  License:     LGPL                                                               *
+ *                                                                                  *
+ ************************************************************************************/
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QVector>
+
+namespace thr {
+
+/**
+ * @brief The TimerWheel class. This class schedules a large number of delayed events
+ * using a single timer.
+ *
+ * @details The events are kept in a circular array of slots, each slot covering
+ * one tick. Scheduling and expiring an event costs constant time regardless of the
+ * number of scheduled events, so thousands of jobs waiting for a retry do not need
+ * thousands of timers. Events, which are further away than one turn of the wheel,
+ * stay in their slot for the required number of turns. <br/><br/>
+ * The timer only runs while there are scheduled events. The class is not thread safe;
+ * it has to be used from the thread it lives in.
+ */
+class TimerWheel : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief TimerWheel. Constructor
+     * @param iTick. Resolution of the wheel in [ms]
+     * @param iSlots. Number of slots in the wheel
+     * @param pParent. Parent object
+     */
+    TimerWheel(int iTick = 10, int iSlots = 512, QObject* pParent = nullptr);
+
+    /**
+     * @brief schedule. Schedules the event
+     * @param iDelay. Delay in [ms]. It is rounded up to the whole number of ticks
+     * @param iId. Event identifier, which is passed to signalExpired()
+     */
+    void schedule(int iDelay, int iId);
+    /**
+     * @brief clear. Removes all the scheduled events
+     */
+    void clear();
+    /**
+     * @brief count. Returns the number of scheduled events
+     * @return number of scheduled events
+     */
+    int count() const
+    {   return m_iCount; }
+
+signals:
+    /**
+     * @brief signalExpired. Emitted when the event expires
+     * @param iId. Event identifier
+     */
+    void signalExpired(int iId);
+
+private slots:
+    /**
+     * @brief advance. Advances the wheel by the number of ticks elapsed since the
+     * last call and emits signalExpired() for every expired event
+     */
+    void advance();
+
+private:
+    /**
+     * @brief The Entry struct. This structure holds one scheduled event
+     */
+    struct Entry
+    {
+        /**
+         * @brief m_iId. Event identifier
+         */
+        int m_iId;
+        /**
+         * @brief m_iRounds. Number of turns of the wheel left before the event expires
+         */
+        int m_iRounds;
+    };
+
+    /**
+     * @brief m_vvSlots. Slots of the wheel
+     */
+    QVector<QVector<Entry> > m_vvSlots;
+    /**
+     * @brief m_iCursor. Index of the slot, which expired last
+     */
+    int m_iCursor;
+    /**
+     * @brief m_iTick. Resolution of the wheel in [ms]
+     */
+    int m_iTick;
+    /**
+     * @brief m_iCount. Number of scheduled events
+     */
+    int m_iCount;
+    /**
+     * @brief m_iTicked. Number of ticks processed since the timer was started
+     */
+    qint64 m_iTicked;
+    /**
+     * @brief m_timer. Timer, which advances the wheel
+     */
+    QTimer m_timer;
+    /**
+     * @brief m_elapsed. Measures the time since the timer was started, so the
+     * ticks are not lost, if the timer fires late
+     */
+    QElapsedTimer m_elapsed;
+};
+
+}   // namespace
+
+#endif // TIMERWHEEL_H
@@ -3,10 +3,16 @@
 #include <QCoreApplication>
 #include <QDebug>
 
+#include <stdexcept>
+
 #include "sessionmanager.h"
 
 #include "jobmanager.h"
 #include "jobqueue.h"
+#include "jobpool.h"
+#include "schedulingpolicies.h"
+#include "dataport.h"
+#include "taskgraph.h"
 #include "abstractjob.h"
 
 //-----------------------------------------------------------------------------
@@ -137,6 +143,438 @@ private:
 
 //-----------------------------------------------------------------------------
 
+class TestJobPooled : public thr::AbstractJob, public thr::PooledJob<TestJobPooled>
+{
+public:
+    TestJobPooled(int iDepth) : thr::AbstractJob()
+    {
+        m_iDepth = iDepth;
+        m_iSpawned = 0;
+    }
+
+    void process()
+    {   }
+
+    thr::AbstractJob* nextSpawnedJob()
+    {
+        if ((m_iDepth > 0) && (m_iSpawned < 2)) {
+            ++m_iSpawned;
+            return new TestJobPooled(m_iDepth - 1);
+        }
+        return nullptr;
+    }
+
+private:
+    int m_iDepth;
+    int m_iSpawned;
+};
+
+//-----------------------------------------------------------------------------
+
+class TestJobDeleted : public thr::AbstractJob
+{
+public:
+    TestJobDeleted(bool* pbDeleted) : thr::AbstractJob()
+    {
+        m_pbDeleted = pbDeleted;
+        *m_pbDeleted = false;
+    }
+
+    ~TestJobDeleted()
+    {   *m_pbDeleted = true; }
+
+    void process()
+    {   }
+
+private:
+    bool* m_pbDeleted;
+};
+
+//-----------------------------------------------------------------------------
+
+class TestJobBlocking : public thr::AbstractJob
+{
+public:
+    TestJobBlocking() : thr::AbstractJob()
+    {   }
+
+    void process()
+    {
+        // wait for at most 10 seconds, unless stopped
+        cancellationToken().wait(10000);
+        CHECK_JOB_STOP();
+    }
+};
+
+//-----------------------------------------------------------------------------
+
+class TestJobHung : public thr::AbstractJob
+{
+public:
+    TestJobHung() : thr::AbstractJob()
+    {   }
+
+    void process()
+    {
+        // ignores the stop flag on purpose
+        QThread::msleep(500);
+    }
+};
+
+//-----------------------------------------------------------------------------
+
+class TestJobFlaky : public thr::AbstractJob
+{
+public:
+    TestJobFlaky(int iFailures, int iError, int iDelay = 10, bool bSpawn = false) : thr::AbstractJob()
+    {
+        m_iFailures = iFailures;
+        m_iError = iError;
+        m_iDelay = iDelay;
+        m_bSpawn = bSpawn;
+        m_bSpawnPending = false;
+    }
+
+    thr::RetryPolicy retryPolicy() const
+    {
+        thr::RetryPolicy policy(3, m_iDelay);
+        policy.m_fnRetryOn = [](int iErr) { return iErr == 2; };
+        return policy;
+    }
+
+    void process()
+    {
+        // every attempt spawns one job
+        m_bSpawnPending = m_bSpawn;
+        if (attempts() <= m_iFailures) {
+            reportError(m_iError);
+        }
+    }
+
+    thr::AbstractJob* nextSpawnedJob()
+    {
+        if (m_bSpawnPending == true) {
+            m_bSpawnPending = false;
+            return new TestJob(10);
+        }
+        return nullptr;
+    }
+
+private:
+    int m_iFailures;
+    int m_iError;
+    int m_iDelay;
+    bool m_bSpawn;
+    bool m_bSpawnPending;
+};
+
+//-----------------------------------------------------------------------------
+
+class TestJobStraggler : public thr::AbstractJob
+{
+public:
+    TestJobStraggler(int iSleep) : thr::AbstractJob()
+    {
+        m_iSleep = iSleep;
+        m_iResult = 0;
+        setIdempotent(true);
+    }
+
+    int result() const
+    {   return m_iResult; }
+
+    thr::AbstractJob* clone() const
+    {
+        // the duplicate does not hit whatever slows down the original
+        return new TestJobStraggler(10);
+    }
+
+    void adoptResult(thr::AbstractJob* pDuplicate)
+    {   m_iResult = static_cast<TestJobStraggler*>(pDuplicate)->m_iResult; }
+
+    void process()
+    {
+        for (int i = 0; i < m_iSleep; i += 5) {
+            CHECK_JOB_STOP();
+            QThread::msleep(5);
+        }
+        m_iResult = 42;
+    }
+
+private:
+    int m_iSleep;
+    int m_iResult;
+};
+
+//-----------------------------------------------------------------------------
+
+class TestJobOrder : public thr::AbstractJob
+{
+public:
+    TestJobOrder(double dCost = 0.0) : thr::AbstractJob()
+    {
+        m_iOrder = -1;
+        setCost(dCost);
+    }
+
+    int order() const
+    {   return m_iOrder; }
+
+    void process()
+    {   m_iOrder = s_iNext.fetchAndAddOrdered(1); }
+
+    static QAtomicInt s_iNext;
+
+private:
+    int m_iOrder;
+};
+
+QAtomicInt TestJobOrder::s_iNext;
+
+//-----------------------------------------------------------------------------
+
+class TestJobWindow : public TestJob
+{
+public:
+    TestJobWindow(const thr::JobManager* pJM, int iIndex, unsigned int uiMax) : TestJob(uiMax)
+    {
+        m_pJM = pJM;
+        m_iIndex = iIndex;
+    }
+
+    void process()
+    {
+        // how far beyond the oldest unreleased job the processing got
+        int iAhead = m_iIndex - m_pJM->releasedCount();
+        int iMax = s_iMaxAhead.loadAcquire();
+        while ((iAhead > iMax) && (s_iMaxAhead.testAndSetOrdered(iMax, iAhead) == false)) {
+            iMax = s_iMaxAhead.loadAcquire();
+        }
+        TestJob::process();
+    }
+
+    static QAtomicInt s_iMaxAhead;
+
+private:
+    const thr::JobManager* m_pJM;
+    int m_iIndex;
+};
+
+QAtomicInt TestJobWindow::s_iMaxAhead;
+
+//-----------------------------------------------------------------------------
+
+class TestJobPausable : public thr::AbstractJob
+{
+public:
+    TestJobPausable() : thr::AbstractJob()
+    {   }
+
+    int steps() const
+    {   return m_iSteps.loadAcquire(); }
+
+    void process()
+    {
+        for (int i = 0; i < 50; ++i) {
+            CHECK_JOB_PAUSE();
+            QThread::msleep(2);
+            m_iSteps.ref();
+        }
+    }
+
+private:
+    QAtomicInt m_iSteps;
+};
+
+//-----------------------------------------------------------------------------
+
+class TestJobCached : public thr::AbstractJob
+{
+public:
+    TestJobCached(int iInput) : thr::AbstractJob()
+    {
+        m_iInput = iInput;
+        m_iResult = 0;
+    }
+
+    int result() const
+    {   return m_iResult; }
+
+    QByteArray cacheKey() const
+    {   return QByteArray::number(m_iInput); }
+
+    void process()
+    {
+        s_iProcessed.ref();
+        m_iResult = m_iInput*m_iInput;
+    }
+
+    static QAtomicInt s_iProcessed;
+
+protected:
+    void saveResult(QDataStream& ds) const
+    {   ds << static_cast<qint32>(m_iResult); }
+
+    bool loadResult(QDataStream& ds)
+    {
+        qint32 iResult = 0;
+        ds >> iResult;
+        m_iResult = iResult;
+        return true;
+    }
+
+private:
+    int m_iInput;
+    int m_iResult;
+};
+
+QAtomicInt TestJobCached::s_iProcessed;
+
+//-----------------------------------------------------------------------------
+
+class TestPayload
+{
+public:
+    TestPayload(int iN = 0) : m_vData(iN, 1)
+    {   }
+
+    TestPayload(const TestPayload& rOther) : m_vData(rOther.m_vData)
+    {   s_iCopies.ref(); }
+
+    TestPayload(TestPayload&& rOther) : m_vData(std::move(rOther.m_vData))
+    {   }
+
+    int sum() const
+    {
+        int iSum = 0;
+        for (int i = 0; i < m_vData.count(); ++i) {
+            iSum += m_vData[i];
+        }
+        return iSum;
+    }
+
+    static QAtomicInt s_iCopies;
+
+private:
+    QVector<int> m_vData;
+};
+
+QAtomicInt TestPayload::s_iCopies;
+
+class TestJobSource : public thr::AbstractJob
+{
+public:
+    TestJobSource() : thr::AbstractJob(), m_out(this)
+    {   }
+
+    void process()
+    {   m_out.set(TestPayload(1000)); }
+
+    thr::OutputPort<TestPayload> m_out;
+};
+
+class TestJobSink : public thr::AbstractJob
+{
+public:
+    TestJobSink(bool bTake) : thr::AbstractJob(), m_in(this)
+    {
+        m_bTake = bTake;
+        m_iSum = 0;
+    }
+
+    int sum() const
+    {   return m_iSum; }
+
+    void process()
+    {
+        if (m_bTake == true) {
+            m_iSum = m_in.take().sum();
+        }   else {
+            m_iSum = m_in.value().sum();
+        }
+    }
+
+    thr::InputPort<TestPayload> m_in;
+
+private:
+    bool m_bTake;
+    int m_iSum;
+};
+
+//-----------------------------------------------------------------------------
+
+class TestJobThrowing : public thr::AbstractJob
+{
+public:
+    TestJobThrowing() : thr::AbstractJob()
+    {   }
+
+    void process()
+    {   throw std::runtime_error("TestJobThrowing"); }
+};
+
+//-----------------------------------------------------------------------------
+
+class TestJobProducer : public thr::AbstractJob
+{
+public:
+    TestJobProducer(thr::JobManager* pJM, int iCount) : thr::AbstractJob()
+    {
+        m_pJM = pJM;
+        m_iCount = iCount;
+    }
+
+    void process()
+    {
+        for (int i = 0; i < m_iCount; ++i) {
+            m_pJM->appendJob(new TestJob(100 + i));
+        }
+    }
+
+private:
+    thr::JobManager* m_pJM;
+    int m_iCount;
+};
+
+//-----------------------------------------------------------------------------
+
+class TestProducerThread : public QThread
+{
+public:
+    TestProducerThread(thr::JobManager* pJM, int iCount, thr::AbstractJob* pWatched = nullptr) : QThread()
+    {
+        m_pJM = pJM;
+        m_iCount = iCount;
+        m_pWatched = pWatched;
+    }
+
+    const QVector<int>& waiting() const
+    {   return m_viWaiting; }
+
+    const QVector<bool>& watchedFinished() const
+    {   return m_vbWatchedFinished; }
+
+protected:
+    void run()
+    {
+        for (int i = 0; i < m_iCount; ++i) {
+            m_pJM->appendJob(new TestJobOrder);
+            // the state seen by the producer, when appendJob() returned
+            m_viWaiting << m_pJM->waitingCount();
+            m_vbWatchedFinished << ((m_pWatched != nullptr) && (m_pWatched->isFinished() == true));
+        }
+    }
+
+private:
+    thr::JobManager* m_pJM;
+    int m_iCount;
+    thr::AbstractJob* m_pWatched;
+    QVector<int> m_viWaiting;
+    QVector<bool> m_vbWatchedFinished;
+};
+
+//-----------------------------------------------------------------------------
+
 class UnitTestsTest : public QObject
 {
     Q_OBJECT
@@ -150,7 +588,8 @@ public slots:
     void setFinished();
     void setError(thr::JobManagerError eJME);
     void setStop();
-    void handleJobFinish(QSharedPointer<thr::AbstractJob> spJob);
+    void handleJobFinish(thr::JobPointer spJob);
+    void handleJobRelease(int iInd, thr::JobPointer spJob);
 
 private Q_SLOTS:
     void singleJobManagerStart();
@@ -174,6 +613,34 @@ private Q_SLOTS:
     void spawnJobs();
     void sessionTest();
     void sessionAddThreads();
+    void sessionPause();
+    void orderedRelease();
+    void jobQueueParallel();
+    void jobQueueNested();
+    void appendFromWorkers();
+    void appendJobsBulk();
+    void pooledJobs();
+    void jobPointer();
+    void cancellationToken();
+    void errorPolicy();
+    void exceptionPropagation();
+    void jobTimeout();
+    void retryPolicy();
+    void retryStop();
+    void speculation();
+    void criticalPath();
+    void longestFirst();
+    void schedulingPolicy();
+    void affinity();
+    void continuation();
+    void idleProfile();
+    void overflowPolicy();
+    void pauseResume();
+    void checkpoint();
+    void resultCache();
+    void invalidate();
+    void dataPorts();
+    void taskGraph();
 
 private:
     void wait();
@@ -189,6 +656,7 @@ private:
 
     QMutex m_mutex;
     QVector<int> m_vFinished;
+    QVector<int> m_vReleased;
 };
 
 //-----------------------------------------------------------------------------
@@ -209,6 +677,7 @@ void UnitTestsTest::clear()
     m_bStop = false;
     m_jm.clear();
     m_vFinished.clear();
+    m_vReleased.clear();
 }
 
 //-----------------------------------------------------------------------------
@@ -234,7 +703,7 @@ void UnitTestsTest::setStop()
 
 //-----------------------------------------------------------------------------
 
-void UnitTestsTest::handleJobFinish(QSharedPointer<thr::AbstractJob> spJob)
+void UnitTestsTest::handleJobFinish(thr::JobPointer spJob)
 {
     QMutexLocker locker(&m_mutex);
     TestJob* pTJ = dynamic_cast<TestJob*>(spJob.data());
@@ -244,9 +713,18 @@ void UnitTestsTest::handleJobFinish(QSharedPointer<thr::AbstractJob> spJob)
 
 //-----------------------------------------------------------------------------
 
-void UnitTestsTest::singleJobManagerStart()
+void UnitTestsTest::handleJobRelease(int iInd, thr::JobPointer spJob)
 {
-    clear();
+    if (spJob->isFinished() == true) {
+        m_vReleased << iInd;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void UnitTestsTest::singleJobManagerStart()
+{
+    clear();
     TestJob* pJob = new TestJob;
     //QVERIFY2(m_sjm.startJob(&m_job), "Test job could not start!");
     m_jm.appendJob(pJob);
@@ -498,11 +976,16 @@ void UnitTestsTest::dependencyProcess()
     thr::JobManager jm(5);
     connect(
                 &jm,
-                SIGNAL(signalJobFinished(QSharedPointer<thr::AbstractJob>)),
+                SIGNAL(signalJobFinished(thr::JobPointer)),
                 this,
-                SLOT(handleJobFinish(QSharedPointer<thr::AbstractJob>))
+                SLOT(handleJobFinish(thr::JobPointer))
                 );
 
+    // the progress can be read from the slot, while the signal is being emitted
+    QVector<int> vProgress;
+    connect(&jm, &thr::JobManager::signalJobFinished, [&jm, &vProgress](thr::JobPointer) {
+        vProgress << jm.finishedCount();
+    });
     jm.setReportJobFinish(true);
 
     TestJob* pJob0 = new TestJob(700);
@@ -536,6 +1019,10 @@ void UnitTestsTest::dependencyProcess()
     QVERIFY2(m_vFinished.indexOf(4) < m_vFinished.indexOf(6), "Job 5 did not before job 7!");
     QVERIFY2(m_vFinished.indexOf(6) < m_vFinished.indexOf(5), "Job 7 did not finish before job 6!");
     QVERIFY2(m_vFinished.last() == 5, "Job 6 did not finish 7th!");
+    QVERIFY2(vProgress.count() == 7, "Finished count not read from the slot!");
+    for (int i = 0; i < vProgress.count(); ++i) {
+        QVERIFY2(vProgress[i] == i + 1, "Wrong finished count read from the slot!");
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -649,6 +1136,1122 @@ void UnitTestsTest::sessionAddThreads()
 
 //-----------------------------------------------------------------------------
 
+void UnitTestsTest::sessionPause()
+{
+    // a pause before the start ends with the start
+    SessionManager sm1;
+    sm1.pause();
+    QVERIFY2(sm1.start() == true, "Paused session manager not started!");
+    QVERIFY2(sm1.isPaused() == false, "Pause outlasted the start!");
+    while (sm1.isRunning() == true) {
+        wait();
+    }
+    QVERIFY2(sm1.isFinished() == true, "Session manager not finished correctly!");
+    QVERIFY2(sm1.finishedJobs() == 350, "Number of finished jobs not right!");
+
+    // stopping ends the pause, so the next start processes the sessions
+    SessionManager sm2;
+    sm2.start();
+    sm2.pause();
+    sm2.stop();
+    while (sm2.isRunning() == true) {
+        wait();
+    }
+    QVERIFY2(sm2.isFinished() == false, "Paused session manager not stopped!");
+    QVERIFY2(sm2.start() == true, "Stopped session manager not started again!");
+    QVERIFY2(sm2.isPaused() == false, "Pause outlasted the stopped processing!");
+    while (sm2.isRunning() == true) {
+        wait();
+    }
+    QVERIFY2(sm2.isFinished() == true, "Session manager not finished after restart!");
+    QVERIFY2(sm2.currentSession() == 3, "Not all sessions finished after restart!");
+}
+
+//-----------------------------------------------------------------------------
+
+void UnitTestsTest::orderedRelease()
+{
+    clear();
+    thr::JobManager jm(4);
+    connect(
+                &jm,
+                SIGNAL(signalJobReleased(int,thr::JobPointer)),
+                this,
+                SLOT(handleJobRelease(int,thr::JobPointer))
+                );
+
+    TestJobWindow::s_iMaxAhead.storeRelease(0);
+    jm.setOrderedRelease(true, 8);
+    for (int i = 0; i < 200; ++i) {
+        jm.appendJob(new TestJobWindow(&jm, i, 100 + 10000*(i % 7)));
+    }
+
+    jm.start();
+    while (jm.isRunning() == true) {
+        wait();
+    }
+
+    QVERIFY2(jm.isFinished() == true, "Job manager not finished correctly!");
+    QVERIFY2(jm.releasedCount() == 200, "Not all jobs released!");
+    QVERIFY2(m_vReleased.count() == 200, "Not all released jobs reported!");
+    for (int i = 0; i < m_vReleased.count(); ++i) {
+        QVERIFY2(m_vReleased[i] == i, "Jobs not released in order!");
+    }
+    QVERIFY2(TestJobWindow::s_iMaxAhead.loadAcquire() < 8, "Job started outside the release window!");
+
+    // a job, which depends on a job outside the window, can never be started
+    clear();
+    thr::JobManager jmOutside(4);
+    connect(&jmOutside, SIGNAL(signalError(thr::JobManagerError)), this, SLOT(setError(thr::JobManagerError)));
+    jmOutside.setOrderedRelease(true, 8);
+    QVector<TestJob*> vpJobs;
+    for (int i = 0; i < 20; ++i) {
+        vpJobs.append(new TestJob);
+        jmOutside.appendJob(vpJobs.last());
+    }
+    vpJobs[0]->addDependency(jmOutside.job(12));
+
+    jmOutside.start();
+    QElapsedTimer timer;
+    timer.start();
+    while ((jmOutside.isRunning() == true) && (timer.elapsed() < 5000)) {
+        wait();
+    }
+
+    QVERIFY2(jmOutside.isRunning() == false, "Job manager hung on a dependency outside the window!");
+    QVERIFY2(m_eError == thr::jmeNoJobReady, "Dependency outside the window not reported!");
+    QVERIFY2(jmOutside.releasedCount() == 0, "Job released before its dependency!");
+}
+
+//-----------------------------------------------------------------------------
+
+void UnitTestsTest::jobQueueParallel()
+{
+    clear();
+    TestJobOrder::s_iNext.storeRelease(0);
+    thr::JobQueue* pQueue = new thr::JobQueue;
+    QVector<TestJob*> vpJobs;
+    QVector<TestJobOrder*> vpOrdered;
+    for (int i = 0; i < 200; ++i) {
+        if ((i % 10) == 0) {
+            TestJobOrder* pJob = new TestJobOrder;
+            vpOrdered << pJob;
+            pQueue->append(pJob, true);
+        }   else {
+            TestJob* pJob = new TestJob(1000 + 10*i);
+            vpJobs << pJob;
+            pQueue->append(pJob);
+        }
+    }
+    pQueue->setParallel(true, 4);
+    m_jm.appendJob(pQueue);
+    QVERIFY2(m_jm.start(), "Parallel job queue not started!");
+
+    while (m_jm.isIdle() == false) {
+        wait();
+    }
+
+    QVERIFY2(m_bFinished == true, "Parallel job queue not finished!");
+    QVERIFY2(m_eError == thr::jmeNoError, "Error signaled!");
+    QVERIFY2(pQueue->progress() == 100, "Parallel job queue progress not 100%!");
+    for (int i = 0; i < vpJobs.count(); ++i) {
+        unsigned int uiMax = vpJobs[i]->max();
+        QVERIFY2(vpJobs[i]->sum() == uiMax*(uiMax + 1)/2, "Queued job not processed!");
+    }
+    for (int i = 0; i < vpOrdered.count(); ++i) {
+        QVERIFY2(vpOrdered[i]->order() == i, "Ordered jobs not processed in their order!");
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void UnitTestsTest::jobQueueNested()
+{
+    // nested parallel queues use more helpers than the pool has threads
+    int iMaxThreads = QThreadPool::globalInstance()->maxThreadCount();
+    QThreadPool::globalInstance()->setMaxThreadCount(2);
+
+    thr::JobManager jm(2);
+    QVector<TestJob*> vpJobs;
+    for (int j = 0; j < 2; ++j) {
+        thr::JobQueue* pOuter = new thr::JobQueue;
+        pOuter->setParallel(true, 4);
+        for (int k = 0; k < 4; ++k) {
+            thr::JobQueue* pInner = new thr::JobQueue;
+            pInner->setParallel(true, 4);
+            for (int i = 0; i < 8; ++i) {
+                TestJob* pJob = new TestJob(1000 + 10*i);
+                vpJobs << pJob;
+                pInner->append(pJob);
+            }
+            pOuter->append(pInner);
+        }
+        jm.appendJob(pOuter);
+    }
+    jm.start();
+    bool bDone = jm.wait(10000);
+    QThreadPool::globalInstance()->setMaxThreadCount(iMaxThreads);
+
+    QVERIFY2(bDone == true, "Nested parallel queues dead-locked!");
+    QVERIFY2(jm.isFinished() == true, "Job manager not finished correctly!");
+    for (int i = 0; i < vpJobs.count(); ++i) {
+        unsigned int uiMax = vpJobs[i]->max();
+        QVERIFY2(vpJobs[i]->sum() == uiMax*(uiMax + 1)/2, "Queued job not processed!");
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void UnitTestsTest::appendFromWorkers()
+{
+    clear();
+    thr::JobManager jm(4);
+    for (int i = 0; i < 4; ++i) {
+        jm.appendJob(new TestJobProducer(&jm, 250));
+    }
+
+    jm.start();
+    while (jm.isRunning() == true) {
+        wait();
+    }
+
+    QVERIFY2(jm.isFinished() == true, "Job manager not finished correctly!");
+    QVERIFY2(jm.jobCount() == 1004, "Jobs appended from workers missing!");
+    QVERIFY2(jm.finishedCount() == 1004, "Jobs appended from workers not processed!");
+
+    // the workers process the jobs themselves, when the queue is full
+    thr::JobManager jmCaller(4);
+    jmCaller.setOverflowPolicy(thr::opCallerRuns, 8);
+    for (int i = 0; i < 4; ++i) {
+        jmCaller.appendJob(new TestJobProducer(&jmCaller, 250));
+    }
+
+    jmCaller.start();
+    while (jmCaller.isRunning() == true) {
+        wait();
+    }
+
+    QVERIFY2(jmCaller.isFinished() == true, "Job manager not finished correctly!");
+    QVERIFY2(jmCaller.jobCount() == 1004, "Jobs processed by workers not collected!");
+    QVERIFY2(jmCaller.finishedCount() == 1004, "Jobs processed by workers not counted!");
+    QVERIFY2(jmCaller.waitingCount() == 0, "Jobs left waiting!");
+}
+
+//-----------------------------------------------------------------------------
+
+void UnitTestsTest::appendJobsBulk()
+{
+    clear();
+    QVector<thr::AbstractJob*> vpJobs;
+    for (int i = 0; i < 1000; ++i) {
+        vpJobs << new TestJob(100 + i);
+    }
+    m_jm.appendJobs(vpJobs);
+
+    QList<thr::AbstractJob*> lpJobs;
+    for (int i = 0; i < 500; ++i) {
+        lpJobs << new TestJob(1100 + i);
+    }
+    m_jm.appendJobs(lpJobs.begin(), lpJobs.end());
+
+    QVERIFY2(m_jm.jobCount() == 1500, "Jobs not appended correctly!");
+    QVERIFY2(m_jm.start() == true, "Job manager not started correctly!");
+    while (m_jm.isIdle() == false) {
+        wait();
+    }
+
+    QVERIFY2(m_bFinished == true, "Job manager not finished correctly!");
+    QVERIFY2(m_jm.finishedCount() == 1500, "Not all jobs processed!");
+    QVERIFY2(
+                dynamic_cast<TestJob*>(m_jm.job(1499).data())->sum() == 1599*1600/2,
+                "Sum not correct!"
+                );
+}
+
+//-----------------------------------------------------------------------------
+
+void UnitTestsTest::pooledJobs()
+{
+    TestJobPooled* pJob1 = new TestJobPooled(0);
+    quintptr uiJob1 = reinterpret_cast<quintptr>(pJob1);
+    delete pJob1;
+    int iFree = thr::JobPool<TestJobPooled>::freeCount();
+    QVERIFY2(iFree > 0, "Job memory not returned to the pool!");
+    TestJobPooled* pJob2 = new TestJobPooled(0);
+    QVERIFY2(thr::JobPool<TestJobPooled>::freeCount() == iFree - 1, "Job memory not reused!");
+    QVERIFY2(reinterpret_cast<quintptr>(pJob2) == uiJob1, "Last released memory not reused first!");
+    delete pJob2;
+
+    thr::JobManager jm(4);
+    jm.appendJob(new TestJobPooled(6));
+    jm.start();
+    while (jm.isRunning() == true) {
+        wait();
+    }
+
+    QVERIFY2(jm.isFinished() == true, "Job manager not finished correctly!");
+    QVERIFY2(jm.jobCount() == 127, "Not all pooled jobs spawned!");
+    QVERIFY2(jm.finishedCount() == 127, "Not all pooled jobs processed!");
+    jm.clear();
+    thr::JobPool<TestJobPooled>::trim();
+}
+
+//-----------------------------------------------------------------------------
+
+void UnitTestsTest::jobPointer()
+{
+    bool bDeleted1;
+    bool bDeleted2;
+    thr::JobPointer spKept;
+    {
+        thr::JobManager jm(2);
+        jm.appendJob(new TestJobDeleted(&bDeleted1));
+        jm.appendJob(new TestJobDeleted(&bDeleted2));
+        jm.job(1)->addDependency(jm.job(0));
+        spKept = jm.job(1);
+
+        thr::JobPointer spMoved(jm.job(0));
+        thr::JobPointer spTarget(std::move(spMoved));
+        QVERIFY2(spMoved.isNull() == true, "Moved pointer not null!");
+        QVERIFY2(spTarget == jm.job(0), "Moved pointer does not reference the job!");
+
+        jm.start();
+        while (jm.isRunning() == true) {
+            wait();
+        }
+        QVERIFY2(jm.isFinished() == true, "Job manager not finished correctly!");
+    }
+
+    QVERIFY2(bDeleted1 == true, "Job not deleted with the job manager!");
+    QVERIFY2(bDeleted2 == false, "Referenced job deleted with the job manager!");
+    spKept.clear();
+    QVERIFY2(bDeleted2 == true, "Job not deleted with its last reference!");
+}
+
+//-----------------------------------------------------------------------------
+
+void UnitTestsTest::cancellationToken()
+{
+    thr::CancellationToken parent;
+    thr::CancellationToken child;
+    child.setParent(&parent);
+    int iCalled = 0;
+    child.addCallback([&iCalled]() { ++iCalled; });
+    parent.cancel();
+    QVERIFY2(child.isCancelled() == true, "Child token not cancelled with its parent!");
+    QVERIFY2(iCalled == 1, "Cancellation callback not invoked!");
+    child.reset();
+    QVERIFY2(child.isCancelled() == true, "Child token reset while parent cancelled!");
+    parent.reset();
+    child.reset();
+    QVERIFY2(child.isCancelled() == false, "Child token not reset!");
+
+    thr::JobManager jm(2);
+    jm.appendJob(new TestJobBlocking);
+    jm.appendJob(new TestJobBlocking);
+    jm.appendJob(new TestJobBlocking);
+    jm.start();
+    QTest::qWait(50);
+    // the callback is called without the JobManager being locked
+    int iFinished = -1;
+    jm.job(0)->cancellationToken().addCallback([&jm, &iFinished]() { iFinished = jm.finishedCount(); });
+    jm.stop();
+    QVERIFY2(iFinished == 0, "Cancellation callback not invoked by stop!");
+    while (jm.isRunning() == true) {
+        wait();
+    }
+    QVERIFY2(jm.isStopped() == true, "Job manager not stopped correctly!");
+    QVERIFY2(jm.finishedCount() == 2, "Queued job started after stop!");
+    QVERIFY2((jm.stopLatency() >= 0) && (jm.stopLatency() < 5000), "Blocked jobs not woken up by stop!");
+}
+
+//-----------------------------------------------------------------------------
+
+void UnitTestsTest::errorPolicy()
+{
+    QVector<thr::JobErrorPolicy> vPolicies;
+    vPolicies << thr::jepSkipDependents << thr::jepCancelDependents;
+    for (int i = 0; i < vPolicies.count(); ++i) {
+        thr::JobManager jm(2);
+        jm.setErrorPolicy(vPolicies[i]);
+        jm.setAllowedErrors(-1);
+        jm.appendJob(new TestJobError(1));
+        jm.appendJob(new TestJob(1000));
+        jm.appendJob(new TestJob(1000));
+        jm.appendJob(new TestJob(1000));
+        jm.job(1)->addDependency(jm.job(0));
+        jm.job(2)->addDependency(jm.job(1));
+        jm.start();
+        while (jm.isRunning() == true) {
+            wait();
+        }
+        QVERIFY2(jm.isFinished() == true, "Job manager not finished correctly!");
+        QVERIFY2(jm.droppedCount() == 2, "Dependents of failed job not dropped!");
+        QVERIFY2(jm.job(3)->isFinished() == true, "Independent job not processed!");
+        QVERIFY2(jm.job(2)->isFinished() == false, "Dependent job processed!");
+        if (vPolicies[i] == thr::jepSkipDependents) {
+            QVERIFY2(jm.job(2)->isSkipped() == true, "Dependent job not skipped!");
+        }   else {
+            QVERIFY2(jm.job(2)->isStopped() == true, "Dependent job not cancelled!");
+        }
+    }
+
+    // a long chain queued in the opposite order of its dependencies is dropped at once
+    thr::JobManager jmChain(2);
+    jmChain.setErrorPolicy(thr::jepCancelDependents);
+    jmChain.setAllowedErrors(-1);
+    jmChain.appendJob(new TestJobError(1));
+    for (int i = 1; i <= 2000; ++i) {
+        jmChain.appendJob(new TestJob(10));
+    }
+    for (int i = 1; i < 2000; ++i) {
+        jmChain.job(i)->addDependency(jmChain.job(i + 1));
+    }
+    jmChain.job(2000)->addDependency(jmChain.job(0));
+    jmChain.appendJob(new TestJob(1000));
+    jmChain.start();
+    while (jmChain.isRunning() == true) {
+        wait();
+    }
+    QVERIFY2(jmChain.isFinished() == true, "Job manager not finished correctly!");
+    QVERIFY2(jmChain.droppedCount() == 2000, "Dependents of failed job not dropped!");
+    QVERIFY2(jmChain.job(1)->isStopped() == true, "End of the chain not cancelled!");
+    QVERIFY2(jmChain.job(2001)->isFinished() == true, "Independent job not processed!");
+}
+
+//-----------------------------------------------------------------------------
+
+void UnitTestsTest::exceptionPropagation()
+{
+    thr::JobManager jm(2);
+    jm.setAllowedErrors(1);
+    jm.appendJob(new TestJob(1000));
+    jm.appendJob(new TestJobThrowing);
+    jm.appendJob(new TestJob(1000));
+    jm.start();
+    bool bCaught = false;
+    try {
+        jm.wait();
+    }   catch (const std::runtime_error&) {
+        bCaught = true;
+    }
+    QVERIFY2(bCaught == true, "Exception not rethrown by wait()!");
+    QVERIFY2(jm.isFinished() == true, "Job manager not finished with one allowed error!");
+    QVERIFY2(jm.job(1)->errorCode() == thr::jeException, "Wrong error code for exception!");
+    QVERIFY2(jm.job(2)->isFinished() == true, "Job after exception not processed!");
+
+    thr::JobQueue* pQueue = new thr::JobQueue;
+    pQueue->setParallel(true, 2);
+    pQueue->append(new TestJob(1000));
+    pQueue->append(new TestJobThrowing);
+    jm.clear();
+    jm.setAllowedErrors(0);
+    jm.appendJob(pQueue);
+    jm.start();
+    bCaught = false;
+    try {
+        jm.wait();
+    }   catch (const std::runtime_error&) {
+        bCaught = true;
+    }
+    QVERIFY2(bCaught == true, "Exception from parallel queue not rethrown!");
+    QVERIFY2(jm.isFinished() == false, "Job manager did not stop on exception!");
+}
+
+//-----------------------------------------------------------------------------
+
+void UnitTestsTest::jobTimeout()
+{
+    thr::JobManager jm(1);
+    jm.setAllowedErrors(2);
+    jm.setJobTimeout(50);
+    jm.appendJob(new TestJobHung);
+    jm.appendJob(new TestJobBlocking);
+    jm.appendJob(new TestJob(1000));
+    jm.job(1)->setTimeout(20);
+    // the slot reads the expired jobs, while the timeout is being reported
+    QVector<int> vReported;
+    QVector<QVector<int> > vvTimedOut;
+    connect(&jm, &thr::JobManager::signalJobTimeout, [&jm, &vReported, &vvTimedOut](int iInd, const thr::JobPointer&) {
+        vReported << iInd;
+        vvTimedOut << jm.timedOutJobs();
+    });
+    jm.start();
+    jm.wait();
+    QVERIFY2(jm.isFinished() == true, "Job manager not finished after timeouts!");
+    // the hung job would have finished without an error, if it was not abandoned
+    QVERIFY2(jm.job(0)->errorCode() == thr::jeTimeout, "Wrong error code for expired job!");
+    QVERIFY2(jm.job(0)->isFinished() == false, "Hung job not abandoned!");
+    QVERIFY2(jm.job(1)->errorCode() == thr::jeTimeout, "Wrong error code for expired job!");
+    QVERIFY2(jm.job(1)->isStopped() == true, "Expired job not stopped!");
+    QVERIFY2(jm.job(2)->isFinished() == true, "Job after expired jobs not processed!");
+    QVERIFY2(jm.timedOutJobs() == (QVector<int>() << 0 << 1), "Expired jobs not reported!");
+    QVERIFY2(vReported == (QVector<int>() << 0 << 1), "Expired jobs not signalled!");
+    QVERIFY2(vvTimedOut.count() == 2, "Expired jobs not read from the slot!");
+    QVERIFY2(vvTimedOut[0] == (QVector<int>() << 0), "Wrong expired jobs read from the slot!");
+    QVERIFY2(vvTimedOut[1] == (QVector<int>() << 0 << 1), "Wrong expired jobs read from the slot!");
+}
+
+//-----------------------------------------------------------------------------
+
+void UnitTestsTest::retryPolicy()
+{
+    thr::RetryPolicy policy(5, 10, 2.0, 50);
+    QVERIFY2(policy.delay(1) == 10, "Wrong initial delay!");
+    QVERIFY2(policy.delay(3) == 40, "Wrong backoff delay!");
+    QVERIFY2(policy.delay(4) == 50, "Maximal delay exceeded!");
+
+    thr::JobManager jm(2);
+    jm.setAllowedErrors(2);
+    jm.appendJob(new TestJobFlaky(2, 2));
+    jm.appendJob(new TestJobFlaky(1, 3));
+    jm.appendJob(new TestJobFlaky(5, 2));
+    jm.start();
+    jm.wait();
+    QVERIFY2(jm.isFinished() == true, "Job manager not finished correctly!");
+    QVERIFY2(jm.job(0)->isFinished() == true, "Transient failure not retried!");
+    QVERIFY2(jm.job(0)->attempts() == 3, "Wrong number of attempts!");
+    QVERIFY2(jm.job(1)->attempts() == 1, "Error not matching the predicate retried!");
+    QVERIFY2(jm.job(2)->attempts() == 3, "Maximal number of attempts exceeded!");
+    QVERIFY2(jm.retryCount() == 4, "Wrong number of retries!");
+}
+
+//-----------------------------------------------------------------------------
+
+void UnitTestsTest::retryStop()
+{
+    // only the jobs spawned by the successful attempt are processed
+    thr::JobManager jm(2);
+    jm.appendJob(new TestJobFlaky(2, 2, 10, true));
+    jm.start();
+    jm.wait();
+    QVERIFY2(jm.isFinished() == true, "Job manager not finished correctly!");
+    QVERIFY2(jm.job(0)->attempts() == 3, "Wrong number of attempts!");
+    QVERIFY2(jm.jobCount() == 2, "Jobs spawned by a failed attempt processed!");
+
+    // stopping while the only job waits for its retry
+    thr::JobManager jmStop(2);
+    // the retry delay is far longer than the test may wait for the stop
+    jmStop.appendJob(new TestJobFlaky(2, 2, 60000));
+    jmStop.start();
+    QElapsedTimer timer;
+    timer.start();
+    while ((jmStop.retryCount() == 0) && (timer.elapsed() < 10000)) {
+        QCoreApplication::instance()->processEvents();
+    }
+    QVERIFY2(jmStop.retryCount() == 1, "Failed attempt not retried!");
+    jmStop.stop();
+    QVERIFY2(jmStop.wait(10000) == true, "Stop waited for retry delay!");
+    QVERIFY2(jmStop.isStopped() == true, "Job manager not stopped correctly!");
+    QVERIFY2(jmStop.job(0)->attempts() == 1, "Job retried after stop!");
+}
+
+//-----------------------------------------------------------------------------
+
+void UnitTestsTest::speculation()
+{
+    thr::JobManager jm(2);
+    jm.setSpeculation(true, 3.0, 3);
+    for (int i = 0; i < 5; ++i) {
+        jm.appendJob(new TestJobStraggler(10));
+    }
+    jm.appendJob(new TestJobStraggler(3000));
+    jm.start();
+    jm.wait();
+    QVERIFY2(jm.isFinished() == true, "Job manager not finished correctly!");
+    QVERIFY2(jm.speculationWins() == 1, "Straggler not duplicated!");
+    QVERIFY2(jm.threadsRunningCount() == 0, "Finished while the stopped original was running!");
+    QVERIFY2(jm.job(5)->isFinished() == true, "Straggler not finished!");
+    QVERIFY2(static_cast<TestJobStraggler*>(jm.job(5).data())->result() == 42, "Result not adopted!");
+}
+
+//-----------------------------------------------------------------------------
+
+void UnitTestsTest::criticalPath()
+{
+    TestJobOrder::s_iNext.storeRelease(0);
+    thr::JobManager jm(1);
+    jm.setCriticalPathScheduling(true);
+    jm.appendJob(new TestJobOrder(10));
+    jm.appendJob(new TestJobOrder(5));
+    jm.appendJob(new TestJobOrder(5));
+    jm.appendJob(new TestJobOrder(5));
+    jm.job(2)->addDependency(jm.job(1));
+    jm.job(3)->addDependency(jm.job(2));
+    jm.start();
+    jm.wait();
+    QVERIFY2(jm.isFinished() == true, "Job manager not finished correctly!");
+    QVERIFY2(qAbs(jm.rank(1) - 15.0) < 1e-9, "Wrong upward rank!");
+    QVERIFY2(qAbs(jm.rank(0) - 10.0) < 1e-9, "Wrong upward rank of independent job!");
+    auto pFirst = static_cast<TestJobOrder*>(jm.job(1).data());
+    QVERIFY2(pFirst->order() == 0, "Job on the critical path not started first!");
+}
+
+//-----------------------------------------------------------------------------
+
+void UnitTestsTest::longestFirst()
+{
+    TestJobOrder::s_iNext.storeRelease(0);
+    thr::JobManager jm(1);
+    jm.setLongestFirstScheduling(true);
+    jm.appendJob(new TestJobOrder(1));
+    jm.appendJob(new TestJobOrder(5));
+    jm.appendJob(new TestJobOrder(100));
+    QVERIFY2(jm.estimatedRemainingTime() < 0, "Remaining time estimated before start!");
+    jm.start();
+    jm.wait();
+    QVERIFY2(jm.isFinished() == true, "Job manager not finished correctly!");
+    QVERIFY2(static_cast<TestJobOrder*>(jm.job(2).data())->order() == 0, "Longest job not started first!");
+    QVERIFY2(static_cast<TestJobOrder*>(jm.job(1).data())->order() == 1, "Jobs not started by cost!");
+    QVERIFY2(static_cast<TestJobOrder*>(jm.job(0).data())->order() == 2, "Shortest job not started last!");
+    QVERIFY2(jm.estimatedRemainingTime() == 0, "Remaining time not 0 after finish!");
+}
+
+//-----------------------------------------------------------------------------
+
+void UnitTestsTest::schedulingPolicy()
+{
+    TestJobOrder::s_iNext.storeRelease(0);
+    thr::JobManager jm(1);
+    jm.setSchedulingPolicy(new thr::LifoPolicy);
+    for (int i = 0; i < 3; ++i) {
+        jm.appendJob(new TestJobOrder);
+    }
+    jm.start();
+    jm.wait();
+    QVERIFY2(jm.isFinished() == true, "Job manager not finished correctly!");
+    for (int i = 0; i < 3; ++i) {
+        QVERIFY2(static_cast<TestJobOrder*>(jm.job(i).data())->order() == 2 - i, "Jobs not started in LIFO order!");
+    }
+
+    TestJobOrder::s_iNext.storeRelease(0);
+    jm.clear();
+    jm.setSchedulingPolicy(new thr::PriorityPolicy);
+    int aiPriority[] = { 0, 3, 1 };
+    for (int i = 0; i < 3; ++i) {
+        TestJobOrder* pJob = new TestJobOrder;
+        pJob->setPriority(aiPriority[i]);
+        jm.appendJob(pJob);
+    }
+    jm.start();
+    jm.wait();
+    QVERIFY2(jm.isFinished() == true, "Job manager not finished correctly!");
+    QVERIFY2(static_cast<TestJobOrder*>(jm.job(1).data())->order() == 0, "Highest priority job not started first!");
+    QVERIFY2(static_cast<TestJobOrder*>(jm.job(2).data())->order() == 1, "Jobs not started by priority!");
+    QVERIFY2(static_cast<TestJobOrder*>(jm.job(0).data())->order() == 2, "Lowest priority job not started last!");
+
+    // the dependent job should follow its dependency into the same thread
+    thr::JobManager jmLocal(2);
+    jmLocal.setSchedulingPolicy(new thr::LocalityPolicy);
+    jmLocal.appendJob(new TestJobOrder);
+    jmLocal.appendJob(new TestJobOrder);
+    jmLocal.job(1)->addDependency(jmLocal.job(0));
+    jmLocal.start();
+    jmLocal.wait();
+    QVERIFY2(jmLocal.isFinished() == true, "Job manager not finished correctly!");
+    QVERIFY2(jmLocal.job(1)->worker() == jmLocal.job(0)->worker(), "Dependent job not processed in the thread of its dependency!");
+}
+
+//-----------------------------------------------------------------------------
+
+void UnitTestsTest::affinity()
+{
+    thr::JobManager jm(2);
+    jm.setSchedulingPolicy(new thr::LocalityPolicy);
+    for (int i = 0; i < 8; ++i) {
+        TestJobOrder* pJob = new TestJobOrder;
+        pJob->setAffinityKey(i % 2);
+        jm.appendJob(pJob);
+    }
+    // every job becomes ready, when its preferred thread becomes idle
+    for (int i = 2; i < 8; ++i) {
+        jm.job(i)->addDependency(jm.job(i - 2));
+    }
+    jm.appendJob(new TestJobOrder);
+    jm.job(8)->addDependency(jm.job(7));
+    jm.job(8)->setAffinityJob(jm.job(3));
+    jm.start();
+    jm.wait();
+    QVERIFY2(jm.isFinished() == true, "Job manager not finished correctly!");
+    QVERIFY2(jm.job(0)->worker() != jm.job(1)->worker(), "Jobs not spread over both threads!");
+    for (int i = 2; i < 8; ++i) {
+        QVERIFY2(jm.job(i)->worker() == jm.job(i % 2)->worker(), "Jobs with the same key processed in different threads!");
+    }
+    QVERIFY2(jm.job(8)->worker() == jm.job(3)->worker(), "Job not processed in the thread of its affinity job!");
+}
+
+//-----------------------------------------------------------------------------
+
+void UnitTestsTest::continuation()
+{
+    thr::JobManager jm(2);
+    jm.setContinuationDepth(10);
+    for (int i = 0; i < 6; ++i) {
+        jm.appendJob(new TestJobOrder);
+    }
+    // jobs 0-4 form a chain, job 5 keeps the other thread busy at the start
+    for (int i = 1; i < 5; ++i) {
+        jm.job(i)->addDependency(jm.job(i - 1));
+    }
+    jm.start();
+    jm.wait();
+    QVERIFY2(jm.isFinished() == true, "Job manager not finished correctly!");
+    QVERIFY2(jm.continuedCount() == 4, "Wrong number of continuations!");
+    for (int i = 1; i < 5; ++i) {
+        QVERIFY2(jm.job(i)->worker() == jm.job(0)->worker(), "Continuation not processed in the thread of its dependency!");
+    }
+
+    // the chain is interrupted after every two continuations
+    thr::JobManager jmBound(1);
+    jmBound.setContinuationDepth(2);
+    for (int i = 0; i < 5; ++i) {
+        jmBound.appendJob(new TestJobOrder);
+        if (i > 0) {
+            jmBound.job(i)->addDependency(jmBound.job(i - 1));
+        }
+    }
+    jmBound.start();
+    jmBound.wait();
+    QVERIFY2(jmBound.isFinished() == true, "Job manager not finished correctly!");
+    QVERIFY2(jmBound.continuedCount() == 3, "Continuation depth not respected!");
+
+    // the jobs spawned along a chain are appended in this thread, while it reads them
+    thr::JobManager jmSpawn(2);
+    jmSpawn.setContinuationDepth(10);
+    for (int i = 0; i < 20; ++i) {
+        jmSpawn.appendJob(new TestJobSpawned);
+        if (i > 0) {
+            jmSpawn.job(i)->addDependency(jmSpawn.job(i - 1));
+        }
+    }
+    jmSpawn.start();
+    while (jmSpawn.isRunning() == true) {
+        int iN = jmSpawn.jobCount();
+        for (int i = 0; i < iN; ++i) {
+            QVERIFY2(jmSpawn.job(i).isNull() == false, "Job not readable during the chain!");
+        }
+        wait();
+    }
+    QVERIFY2(jmSpawn.isFinished() == true, "Job manager not finished correctly!");
+    QVERIFY2(jmSpawn.jobCount() == 60, "Jobs spawned along the chain missing!");
+    QVERIFY2(jmSpawn.finishedCount() == 60, "Jobs spawned along the chain not processed!");
+    for (int i = 20; i < 60; ++i) {
+        QVERIFY2(jmSpawn.job(i)->isSpawned() == true, "Spawned job not marked!");
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void UnitTestsTest::idleProfile()
+{
+    thr::IdleProfile aeProfile[] = { thr::ipLowLatency, thr::ipBalanced, thr::ipPowerSaving };
+    thr::JobManager jm(2);
+    for (int i = 0; i < 3; ++i) {
+        jm.clear();
+        jm.setIdleProfile(aeProfile[i]);
+        QVERIFY2(jm.idleProfile() == aeProfile[i], "Idle profile not set!");
+        for (int j = 0; j < 20; ++j) {
+            jm.appendJob(new TestJobOrder);
+        }
+        // the same threads process all the sessions
+        jm.start();
+        jm.wait();
+        QVERIFY2(jm.isFinished() == true, "Job manager not finished correctly!");
+        QVERIFY2(jm.finishedCount() == 20, "Not all jobs finished!");
+        QVERIFY2(jm.threadsRunningCount() == 0, "Idle threads counted as running!");
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void UnitTestsTest::overflowPolicy()
+{
+    TestJobOrder::s_iNext.storeRelease(0);
+    thr::JobManager jm(1);
+    jm.setOverflowPolicy(thr::opCallerRuns, 2);
+    jm.appendJob(new TestJobHung);
+    jm.start();
+    // the only thread is busy, so the queue fills up and the caller has to help
+    QVector<TestJobOrder*> vpJobs;
+    for (int i = 0; i < 5; ++i) {
+        vpJobs.append(new TestJobOrder);
+        jm.appendJob(vpJobs.last());
+    }
+    QVERIFY2(vpJobs[0]->order() < 0, "Job processed before the queue was full!");
+    for (int i = 2; i < 5; ++i) {
+        QVERIFY2(vpJobs[i]->order() == i - 2, "Job not processed by the caller!");
+    }
+    jm.wait();
+    QVERIFY2(jm.isFinished() == true, "Job manager not finished correctly!");
+    QVERIFY2(jm.jobCount() == 6, "Jobs processed by the caller not collected!");
+    QVERIFY2(jm.finishedCount() == 6, "Jobs processed by the caller not counted!");
+
+    // the JobManager's own thread is never blocked
+    jm.clear();
+    jm.setOverflowPolicy(thr::opBlock, 1);
+    jm.appendJob(new TestJobHung);
+    jm.start();
+    for (int i = 0; i < 3; ++i) {
+        jm.appendJob(new TestJobOrder);
+    }
+    jm.wait();
+    QVERIFY2(jm.isFinished() == true, "Job manager not finished correctly!");
+    QVERIFY2(jm.finishedCount() == 4, "Not all jobs finished!");
+
+    // another thread is blocked while the queue is full and released, when a job starts
+    thr::JobManager jmBlock(2);
+    jmBlock.setOverflowPolicy(thr::opBlock, 1);
+    TestJobHung* pHung = new TestJobHung;
+    jmBlock.appendJob(pHung);
+    // keeps the processing going, until the producer is done
+    jmBlock.appendJob(new TestJobStraggler(1500));
+    jmBlock.start();
+    TestProducerThread producer(&jmBlock, 3, pHung);
+    producer.start();
+    QElapsedTimer timer;
+    timer.start();
+    while ((producer.isFinished() == false) && (timer.elapsed() < 5000)) {
+        QCoreApplication::instance()->processEvents();
+    }
+    QVERIFY2(producer.wait(1000) == true, "Producer not released!");
+    QVERIFY2(producer.waiting().count() == 3, "Not all jobs appended by the producer!");
+    for (int i = 0; i < producer.waiting().count(); ++i) {
+        QVERIFY2(producer.waiting()[i] <= 1, "Producer got past the limit of waiting jobs!");
+    }
+    // both threads are busy, so the second job is only accepted after the hung job
+    // finished and its thread started the first one
+    for (int i = 1; i < producer.watchedFinished().count(); ++i) {
+        QVERIFY2(producer.watchedFinished()[i] == true, "Producer not blocked while the queue was full!");
+    }
+    jmBlock.wait();
+    QVERIFY2(jmBlock.isFinished() == true, "Job manager not finished correctly!");
+    QVERIFY2(jmBlock.finishedCount() == 5, "Jobs of the producer not finished!");
+
+    // a producer appends and helps, while the processing is being started
+    thr::JobManager jmStart(2);
+    jmStart.setOverflowPolicy(thr::opCallerRuns, 4);
+    for (int i = 0; i < 200; ++i) {
+        jmStart.appendJob(new TestJobOrder);
+    }
+    jmStart.appendJob(new TestJobStraggler(1000));
+    TestProducerThread producerStart(&jmStart, 200);
+    producerStart.start();
+    jmStart.start();
+    timer.start();
+    while ((producerStart.isFinished() == false) && (timer.elapsed() < 5000)) {
+        QCoreApplication::instance()->processEvents();
+    }
+    QVERIFY2(producerStart.wait(1000) == true, "Producer not finished!");
+    jmStart.wait();
+    QVERIFY2(jmStart.isFinished() == true, "Job manager not finished correctly!");
+    QVERIFY2(jmStart.jobCount() == 401, "Jobs of the producer not collected!");
+    QVERIFY2(jmStart.finishedCount() == 401, "Jobs of the producer not finished!");
+}
+
+//-----------------------------------------------------------------------------
+
+void UnitTestsTest::pauseResume()
+{
+    thr::JobManager jm(2);
+    for (int i = 0; i < 4; ++i) {
+        jm.appendJob(new TestJobPausable);
+    }
+    jm.start();
+    jm.pause();
+    QVERIFY2(jm.isPaused() == true, "Job manager not paused!");
+    QTest::qWait(50);
+    int iSteps = 0;
+    for (int i = 0; i < 4; ++i) {
+        iSteps += static_cast<TestJobPausable*>(jm.job(i).data())->steps();
+    }
+    QTest::qWait(100);
+    int iStepsLater = 0;
+    for (int i = 0; i < 4; ++i) {
+        iStepsLater += static_cast<TestJobPausable*>(jm.job(i).data())->steps();
+    }
+    QVERIFY2(iStepsLater == iSteps, "Jobs kept processing while paused!");
+    QVERIFY2(jm.isRunning() == true, "Paused job manager not running!");
+    QVERIFY2(jm.job(3)->attempts() == 0, "Job started while paused!");
+
+    jm.resume();
+    QVERIFY2(jm.isPaused() == false, "Job manager not resumed!");
+    jm.wait();
+    QVERIFY2(jm.isFinished() == true, "Job manager not finished correctly!");
+    for (int i = 0; i < 4; ++i) {
+        QVERIFY2(static_cast<TestJobPausable*>(jm.job(i).data())->steps() == 50, "Progress lost by pausing!");
+    }
+
+    // stopping ends the pause, so the next start processes the jobs
+    thr::JobManager jmStop(2);
+    for (int i = 0; i < 4; ++i) {
+        jmStop.appendJob(new TestJobPausable);
+    }
+    jmStop.start();
+    jmStop.pause();
+    jmStop.stop();
+    jmStop.wait();
+    QVERIFY2(jmStop.isStopped() == true, "Paused job manager not stopped!");
+    QVERIFY2(jmStop.start() == true, "Stopped job manager not started again!");
+    QVERIFY2(jmStop.isPaused() == false, "Pause outlasted the stopped processing!");
+    jmStop.wait();
+    QVERIFY2(jmStop.isFinished() == true, "Job manager not finished after restart!");
+}
+
+//-----------------------------------------------------------------------------
+
+void UnitTestsTest::checkpoint()
+{
+    QString qsFile = QDir::tempPath() + "/threadinglib_checkpoint.dat";
+    QFile::remove(qsFile);
+
+    // the first run is interrupted after the first session
+    SessionManager sm1;
+    sm1.setCheckpointFile(qsFile, true);
+    connect(&sm1, &thr::AbstractSessionManager::signalSessionFinished, [&sm1](int iInd) {
+        if (iInd == 0) {
+            sm1.stop();
+        }
+    });
+    sm1.start();
+    while (sm1.isRunning() == true) {
+        wait();
+    }
+    QVERIFY2(sm1.isFinished() == false, "Session manager not stopped!");
+    QVERIFY2(QFile::exists(qsFile) == true, "Checkpoint file not kept after stop!");
+
+    // pretend the first 10 jobs of the second session were finished as well and the
+    // last record was torn by a crash
+    QFile file(qsFile);
+    QVERIFY2(file.open(QIODevice::Append) == true, "Checkpoint file not accessible!");
+    QDataStream ds(&file);
+    ds.setVersion(QDataStream::Qt_5_0);
+    for (int i = 0; i < 10; ++i) {
+        ds << static_cast<qint8>(2) << static_cast<qint32>(1) << static_cast<qint32>(i);
+    }
+    ds << static_cast<qint8>(2);
+    file.close();
+
+    SessionManager sm2;
+    sm2.setCheckpointFile(qsFile, true);
+    sm2.start();
+    QVERIFY2(sm2.currentSession() == 1, "Processing not resumed from the checkpoint!");
+    QVERIFY2(sm2.finishedJobs() == 60, "Finished jobs not restored from the checkpoint!");
+    while (sm2.isRunning() == true) {
+        wait();
+    }
+
+    QVERIFY2(sm2.isFinished() == true, "Session manager not finished correctly!");
+    QVERIFY2(sm2.currentSession() == 3, "Not all sessions finished!");
+    QVERIFY2(sm2.finishedJobs() == 350, "Number of finished jobs not right!");
+    QVERIFY2(QFile::exists(qsFile) == false, "Checkpoint file not removed!");
+
+    // a file, which is not a checkpoint file, is refused and left as it is
+    QByteArray baForeign("not a checkpoint file");
+    QVERIFY2(file.open(QIODevice::WriteOnly) == true, "Checkpoint file not accessible!");
+    file.write(baForeign);
+    file.close();
+    SessionManager sm3;
+    thr::JobManagerError eError = thr::jmeNoError;
+    connect(&sm3, &thr::AbstractSessionManager::signalError, [&eError](int, thr::JobManagerError eJME) {
+        eError = eJME;
+    });
+    sm3.setCheckpointFile(qsFile);
+    QVERIFY2(sm3.start() == false, "Foreign checkpoint file not refused!");
+    QVERIFY2(eError == thr::jmeCouldNotStart, "Foreign checkpoint file not reported!");
+    QVERIFY2(file.open(QIODevice::ReadOnly) == true, "Foreign file removed!");
+    QVERIFY2(file.readAll() == baForeign, "Foreign file overwritten!");
+    file.close();
+
+    // so is a checkpoint file of a newer version
+    QVERIFY2(file.open(QIODevice::WriteOnly) == true, "Checkpoint file not accessible!");
+    QDataStream dsNewer(&file);
+    dsNewer.setVersion(QDataStream::Qt_5_0);
+    dsNewer << static_cast<quint32>(0x54484a4e) << static_cast<qint32>(2);
+    dsNewer << static_cast<qint8>(1) << static_cast<qint32>(0) << static_cast<qint32>(100);
+    file.close();
+    eError = thr::jmeNoError;
+    QVERIFY2(sm3.start() == false, "Newer checkpoint file not refused!");
+    QVERIFY2(eError == thr::jmeCouldNotStart, "Newer checkpoint file not reported!");
+    QVERIFY2(QFileInfo(qsFile).size() == 17, "Newer checkpoint file overwritten!");
+    QFile::remove(qsFile);
+}
+
+//-----------------------------------------------------------------------------
+
+void UnitTestsTest::resultCache()
+{
+    QString qsDir = QDir::tempPath() + "/threadinglib_cache";
+    QDir(qsDir).removeRecursively();
+    TestJobCached::s_iProcessed.storeRelease(0);
+
+    thr::ResultCache cache(1024*1024, qsDir);
+    for (int iRun = 0; iRun < 2; ++iRun) {
+        thr::JobManager jm;
+        jm.setResultCache(&cache);
+        for (int i = 0; i < 20; ++i) {
+            jm.appendJob(new TestJobCached(i));
+        }
+        jm.start();
+        jm.wait();
+        QVERIFY2(jm.isFinished() == true, "Job manager not finished correctly!");
+        for (int i = 0; i < 20; ++i) {
+            auto pJob = static_cast<TestJobCached*>(jm.job(i).data());
+            QVERIFY2(pJob->result() == i*i, "Wrong result!");
+            QVERIFY2(pJob->isCached() == (iRun > 0), "Result not taken from the cache!");
+        }
+    }
+    QVERIFY2(TestJobCached::s_iProcessed.loadAcquire() == 20, "Cached jobs processed again!");
+    QVERIFY2(cache.hits() == 20, "Wrong number of cache hits!");
+
+    // the jobs in a queue are looked up as well
+    thr::JobManager jmQueue;
+    jmQueue.setResultCache(&cache);
+    auto pQueue = new thr::JobQueue;
+    QVector<TestJobCached*> vpQueued;
+    for (int i = 0; i < 3; ++i) {
+        vpQueued.append(new TestJobCached(i + 2));
+        pQueue->append(vpQueued.last());
+    }
+    jmQueue.appendJob(pQueue);
+    jmQueue.start();
+    jmQueue.wait();
+    QVERIFY2(jmQueue.isFinished() == true, "Job manager not finished correctly!");
+    for (int i = 0; i < 3; ++i) {
+        QVERIFY2(vpQueued[i]->isCached() == true, "Result of a queued job not taken from the cache!");
+        QVERIFY2(vpQueued[i]->result() == (i + 2)*(i + 2), "Wrong result of a queued job!");
+    }
+    QVERIFY2(TestJobCached::s_iProcessed.loadAcquire() == 20, "Cached queued jobs processed again!");
+
+    // a new cache finds the results on disk
+    thr::ResultCache cacheDisk(1024*1024, qsDir);
+    thr::JobManager jm;
+    jm.setResultCache(&cacheDisk);
+    jm.appendJob(new TestJobCached(7));
+    jm.start();
+    jm.wait();
+    QVERIFY2(jm.job(0)->isCached() == true, "Result not taken from the disk!");
+    QVERIFY2(static_cast<TestJobCached*>(jm.job(0).data())->result() == 49, "Wrong result from the disk!");
+    QVERIFY2(TestJobCached::s_iProcessed.loadAcquire() == 20, "Cached job processed again!");
+    QDir(qsDir).removeRecursively();
+}
+
+//-----------------------------------------------------------------------------
+
+void UnitTestsTest::invalidate()
+{
+    TestJobCached::s_iProcessed.storeRelease(0);
+
+    // job 0 feeds jobs 1 and 2, which both feed job 3; job 4 is independent
+    thr::JobManager jm;
+    for (int i = 0; i < 5; ++i) {
+        jm.appendJob(new TestJobCached(i));
+    }
+    jm.job(1)->addDependency(jm.job(0));
+    jm.job(2)->addDependency(jm.job(0));
+    jm.job(3)->addDependency(jm.job(1));
+    jm.job(3)->addDependency(jm.job(2));
+    jm.start();
+    jm.wait();
+    QVERIFY2(TestJobCached::s_iProcessed.loadAcquire() == 5, "Not all jobs processed!");
+
+    // nothing changed, so nothing is processed again
+    jm.start();
+    jm.wait();
+    QVERIFY2(jm.isFinished() == true, "Job manager not finished correctly!");
+    QVERIFY2(TestJobCached::s_iProcessed.loadAcquire() == 5, "Finished jobs processed again!");
+
+    QVERIFY2(jm.invalidate(1) == 2, "Wrong number of invalidated jobs!");
+    jm.start();
+    jm.wait();
+    QVERIFY2(jm.isFinished() == true, "Job manager not finished correctly!");
+    QVERIFY2(jm.finishedCount() == 5, "Reused jobs not counted!");
+    QVERIFY2(TestJobCached::s_iProcessed.loadAcquire() == 7, "Wrong jobs processed again!");
+
+    QVERIFY2(jm.invalidate(0) == 4, "Wrong number of invalidated jobs!");
+    jm.start();
+    jm.wait();
+    QVERIFY2(TestJobCached::s_iProcessed.loadAcquire() == 11, "Wrong jobs processed again!");
+    for (int i = 0; i < 5; ++i) {
+        QVERIFY2(jm.job(i)->isFinished() == true, "Job not finished!");
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+void UnitTestsTest::dataPorts()
+{
+    TestPayload::s_iCopies.storeRelease(0);
+
+    auto pSource = new TestJobSource;
+    auto pRead = new TestJobSink(false);
+    auto pTake = new TestJobSink(true);
+    pRead->m_in.connect(pSource->m_out);
+    pTake->m_in.connect(pSource->m_out);
+    // the taking sink runs last, so the value can be moved out of the port
+    pTake->addDependency(thr::JobPointer(pRead));
+    QVERIFY2(pSource->m_out.consumerCount() == 2, "Inputs not connected!");
+    QVERIFY2(pRead->dependencies().count() == 1, "Dependency not added by the port!");
+
+    thr::JobManager jm;
+    jm.appendJob(pSource);
+    jm.appendJob(pRead);
+    jm.appendJob(pTake);
+    jm.start();
+    jm.wait();
+
+    QVERIFY2(jm.isFinished() == true, "Job manager not finished correctly!");
+    QVERIFY2(pRead->sum() == 1000, "Wrong value read from the port!");
+    QVERIFY2(pTake->sum() == 1000, "Wrong value taken from the port!");
+    QVERIFY2(TestPayload::s_iCopies.loadAcquire() == 0, "Value copied between the jobs!");
+    QVERIFY2(pSource->m_out.hasValue() == false, "Value not freed after the last consumer!");
+
+    // the freed value is produced again for the invalidated consumer
+    QVERIFY2(jm.invalidate(1) == 3, "Producer of a freed value not invalidated!");
+    jm.start();
+    jm.wait();
+    QVERIFY2(jm.isFinished() == true, "Job manager not finished correctly!");
+    QVERIFY2(pRead->sum() == 1000, "Wrong value read after invalidation!");
+    QVERIFY2(pTake->sum() == 1000, "Wrong value taken after invalidation!");
+    QVERIFY2(pSource->m_out.hasValue() == false, "Value not freed after the second run!");
+}
+
+//-----------------------------------------------------------------------------
+
+void UnitTestsTest::taskGraph()
+{
+    // task 0 feeds tasks 1 and 2, which both feed task 3; task 4 is independent
+    typedef thr::TaskEdges<
+            thr::TaskEdge<0, 1>, thr::TaskEdge<0, 2>,
+            thr::TaskEdge<1, 3>, thr::TaskEdge<2, 3>> Edges;
+    static_assert(Edges::level(0) == 0, "Wrong level of task 0");
+    static_assert(Edges::level(2) == 1, "Wrong level of task 2");
+    static_assert(Edges::level(3) == 2, "Wrong level of task 3");
+    static_assert(Edges::level(4) == 0, "Wrong level of task 4");
+    static_assert(thr::TaskEdges<thr::TaskEdge<0, 1>, thr::TaskEdge<1, 0>>::level(0) == -1, "Cycle not detected");
+
+    int iA = 0, iB = 0, iC = 0, iD = 0, iE = 0;
+    auto spGraph = thr::makeTaskGraph<Edges>(
+                [&iA]() { iA = 1; },
+                [&iA, &iB]() { iB = iA + 1; },
+                [&iA, &iC]() { iC = iA + 2; },
+                [&iB, &iC, &iD]() { iD = iB + iC; },
+                [&iE]() { iE = 5; });
+    QVERIFY2(spGraph->levelCount() == 3, "Wrong number of levels!");
+
+    thr::JobManager jm(4);
+    // levels of 2, 2 and 1 tasks
+    spGraph->appendTo(jm, 4);
+    QVERIFY2(jm.jobCount() == 5, "Wrong number of chunk jobs!");
+    jm.start();
+    jm.wait();
+
+    QVERIFY2(jm.isFinished() == true, "Job manager not finished correctly!");
+    QVERIFY2(iD == 5, "Tasks not processed in the order of the edges!");
+    QVERIFY2(iE == 5, "Independent task not processed!");
+}
+
+//-----------------------------------------------------------------------------
+
 void UnitTestsTest::wait()
 {
     QCoreApplication::instance()->processEvents();